@@ -4,6 +4,7 @@
 #include <WiFi.h>
 #include <atomic>
 #include "status.h"
+#include "poller.h"
 #include "interface.h"
 #include "synchronization/concurrency_queue.h"
 
@@ -12,14 +13,28 @@ private:
     ConcurrencyQueue<Array<uint8_t>> nextMessage;
     std::atomic<uint8_t> status;
     WiFiClient client;
+    // A message is read over many "receive" calls, its body into "message" which is
+    // allocated by the "data length" of "header"
+    uint8_t header[2];
+    std::unique_ptr<uint8_t[]> message;
+    bool isHeader;
+    uint16_t seek;
+    uint16_t length;
+    // "waitMessage" sleeps on it, connections of a "ConnectorPool" share it.
+    // "socket" is the socket which is added to it, -1 if there is none
+    std::shared_ptr<Poller> poller;
+    int socket;
 
 public:
     static std::unique_ptr<IConnection> build(uint16_t queueSize);
+    static std::unique_ptr<IConnection> build(uint16_t queueSize, std::shared_ptr<Poller> poller);
 
 private:
-    Connection(uint16_t queueSize);
+    Connection(uint16_t queueSize, std::shared_ptr<Poller>& poller);
     
     bool setup() noexcept;
+    void disconnect() noexcept;
+    Error::Code writeBuffer(uint8_t* buffer, size_t nBytes);
 
 public:
     Connection() = delete;
@@ -30,9 +45,14 @@ public:
     ~Connection() noexcept;
 
     Error::Code connect(const char* host, uint16_t port);
-    Error::Code loopListen();
+    Error::Code receive();
     Error::Code sendMessage(uint8_t* data, uint16_t nBytes);
+    Error::Code sendMessages(Array<uint8_t>* messages, uint16_t numberMessages);
     Array<uint8_t> getMessage();
+    uint32_t getMessages(Array<uint8_t>* messages, uint32_t max);
+    bool hasMessages();
+    bool waitMessage(uint32_t timeout);
+    void wakeUp();
 };
 
 #endif //_CSO_CONNECTION_H_
\ No newline at end of file
@@ -6,10 +6,25 @@
 
 class IConnection {
 public:
+    virtual ~IConnection() noexcept {}
     virtual Error::Code connect(const char* host, uint16_t port) = 0;
-    virtual Error::Code loopListen() = 0;
+    // Reads what the socket has without blocking, complete messages are taken by "getMessages".
+    // Returns an error if the connection is lost, it is closed then
+    virtual Error::Code receive() = 0;
     virtual Error::Code sendMessage(uint8_t* data, uint16_t nBytes) = 0;
+    // Frames every message and writes all of them at once
+    virtual Error::Code sendMessages(Array<uint8_t>* messages, uint16_t numberMessages) = 0;
     virtual Array<uint8_t> getMessage() = 0;
+    // Moves at most "max" received messages into "messages", returns the number of messages
+    virtual uint32_t getMessages(Array<uint8_t>* messages, uint32_t max) = 0;
+    // Returns true if received messages wait for "getMessages"
+    virtual bool hasMessages() = 0;
+    // Blocks until the socket is readable, a received message waits, "wakeUp" is called
+    // or "timeout" (milli seconds, UINT32_MAX is forever) expires
+    // Returns false if "timeout" expired
+    virtual bool waitMessage(uint32_t timeout) = 0;
+    // Makes the waiting "waitMessage" return
+    virtual void wakeUp() = 0;
 };
 
 #endif // _CSO_CONNECTION_INTERFACE_H_
\ No newline at end of file
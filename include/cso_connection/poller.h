@@ -0,0 +1,51 @@
+#ifndef _CSO_CONNECTION_POLLER_H_
+#define _CSO_CONNECTION_POLLER_H_
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <lwip/sockets.h>
+#include "synchronization/event.h"
+
+// "Poller" sleeps until one of its sockets is readable, "wakeUp" is called or a timeout expires.
+// Connections which share it are waited for by one task (see "ConnectorPool").
+// "wakeUp" writes a byte to a loopback socket which is in every "select", so it wakes up
+// the task from any other task. Without sockets it sleeps on an "Event".
+// "add", "remove" and "wait" run on the waiting task, "wakeUp" runs on any task
+class Poller {
+private:
+    std::unique_ptr<int[]> sockets;
+    uint16_t maxSockets;
+    uint16_t numberSockets;
+    Event event;
+    // It is opened by the first "add", "isWoken" skips writes until the byte is read
+    std::atomic<int> wakeSocket;
+    std::atomic<bool> isWoken;
+    struct sockaddr_in wakeAddr;
+
+public:
+    static std::shared_ptr<Poller> build();
+    static std::shared_ptr<Poller> build(uint16_t maxSockets);
+
+private:
+    Poller(uint16_t maxSockets);
+
+    bool openWakeSocket() noexcept;
+
+public:
+    Poller() = delete;
+    Poller(Poller&& other) = delete;
+    Poller(const Poller& other) = delete;
+    Poller& operator=(const Poller& other) = delete;
+
+    ~Poller() noexcept;
+
+    // Returns false if "maxSockets" are added or the wake socket can not be opened
+    bool add(int socket) noexcept;
+    void remove(int socket) noexcept;
+    // Returns false if "timeout" (milli seconds, UINT32_MAX is forever) expired
+    bool wait(uint32_t timeout) noexcept;
+    void wakeUp() noexcept;
+};
+
+#endif // _CSO_CONNECTION_POLLER_H_
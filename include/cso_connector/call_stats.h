@@ -0,0 +1,33 @@
+#ifndef _CSO_CONNECTOR_CALL_STATS_H_
+#define _CSO_CONNECTOR_CALL_STATS_H_
+
+#include <cstdint>
+
+#define NUMBER_LATENCY_BUCKETS 16
+
+// CallStats is a snapshot of the calls of "Connector::call"
+class CallStats {
+public:
+    // Calls which are waiting for a response
+    uint32_t numberPending;
+    uint32_t numberReplied;
+    uint32_t numberFailed;
+    uint32_t numberTimedOut;
+    uint32_t numberDropped;
+    // Latency histogram of replied and failed calls, bucket 0 counts latencies below 1 milli second,
+    // bucket "idx" counts latencies from 2^(idx - 1) to 2^idx milli seconds, the last bucket counts the rest
+    uint32_t latencyBuckets[NUMBER_LATENCY_BUCKETS];
+    // Latency from "call" to the response (micro seconds)
+    uint64_t totalLatency;
+    uint64_t maxLatency;
+
+public:
+    CallStats() noexcept;
+
+    // Adds the latency (micro seconds) of a call to the histogram
+    void addLatency(uint64_t latency) noexcept;
+    // Latency (micro seconds) below which "percent" of the calls in the histogram are, it is the upper bound of a bucket
+    uint64_t getPercentile(uint8_t percent) const noexcept;
+};
+
+#endif // _CSO_CONNECTOR_CALL_STATS_H_
@@ -0,0 +1,25 @@
+#ifndef _CSO_CONNECTOR_CALL_STATUS_H_
+#define _CSO_CONNECTOR_CALL_STATUS_H_
+
+#include <cstdint>
+
+// The end of a call of "Connector::call"
+class CallStatus {
+public:
+    enum Code : uint8_t {
+        // The peer sent a response
+        Replied = 0,
+        // The handler of the peer returned an error
+        Failed,
+        // The timeout passed before a response
+        TimedOut,
+        // The request could not be queued
+        Dropped,
+    };
+};
+
+// "callID" is the handle returned by "call", "context" is the pointer given to "call".
+// "response" is only valid during the callback, it is nullptr if "status" is not "Replied"
+typedef void (*CallCallback)(uint32_t callID, CallStatus::Code status, uint8_t* response, uint16_t lenResponse, void* context);
+
+#endif // _CSO_CONNECTOR_CALL_STATUS_H_
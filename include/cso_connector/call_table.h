@@ -0,0 +1,93 @@
+#ifndef _CSO_CONNECTOR_CALL_TABLE_H_
+#define _CSO_CONNECTOR_CALL_TABLE_H_
+
+#include <memory>
+#include <cstdint>
+#include "utils/result.h"
+#include "error/error_code.h"
+#include "message/define.h"
+#include "call_stats.h"
+#include "call_status.h"
+#include "synchronization/spin_lock.h"
+
+// Every request and response of "Connector::call" starts with
+// magic(2) | kind(1) | status(1) | callID(4) | timeout(4), followed by the payload
+#define CALL_HEADER_SIZE 12
+#define CALL_MAGIC_0 0xC5
+#define CALL_MAGIC_1 0x52
+#define CALL_KIND_REQUEST 0x01
+#define CALL_KIND_RESPONSE 0x02
+
+// "CallTable" keeps the calls which are waiting for a response.
+// A call ID modulo "capacity" is the index of its entry, so a response finds its call in O(1).
+// Deadlines are kept in a binary min-heap of entry indexes, "expire" only looks at its top.
+class CallTable {
+private:
+    class Entry {
+    public:
+        // 0 if the entry is unused
+        uint32_t callID;
+        // The response has to come from the peer of the request
+        char peer[MAX_CONNECTION_NAME_LENGTH + 1];
+        uint64_t startTime;
+        uint64_t deadline;
+        // Position of the entry in "timers"
+        uint32_t timerIndex;
+        CallCallback onComplete;
+        void* context;
+    };
+
+    uint32_t capacity;
+    Entry* entries;
+
+    // Everything below is guarded by "spin"
+    SpinLock spin;
+    // Stack of unused entry indexes
+    uint32_t* freeIndexes;
+    uint32_t numberFreeIndexes;
+    // Min-heap of entry indexes ordered by "deadline"
+    uint32_t* timers;
+    uint32_t numberTimers;
+    // Increases on every call, so a late response never matches a reused entry
+    uint32_t generation;
+    CallStats stats;
+
+public:
+    static std::unique_ptr<CallTable> build();
+    static std::unique_ptr<CallTable> build(uint32_t capacity);
+
+private:
+    CallTable(uint32_t capacity);
+
+    Entry* findEntry(const char* peer, uint32_t callID) noexcept;
+    void removeEntry(Entry* entry) noexcept;
+    void pushTimer(uint32_t idx) noexcept;
+    void removeTimer(uint32_t position) noexcept;
+    void siftUp(uint32_t position) noexcept;
+    void siftDown(uint32_t position) noexcept;
+    void swapTimers(uint32_t position, uint32_t other) noexcept;
+
+public:
+    CallTable() = delete;
+    CallTable(CallTable&& other) = delete;
+    CallTable(const CallTable& other) = delete;
+    CallTable& operator=(const CallTable& other) = delete;
+
+    ~CallTable() noexcept;
+
+    // Method can invoke on many threads.
+    // Returns the ID of a new call to "peer" which times out after "timeout" (milli seconds)
+    Result<uint32_t> open(const char* peer, uint32_t timeout, CallCallback onComplete, void* context) noexcept;
+    // Ends a call, "onComplete" of the call is called on the current thread.
+    // Returns false if the call is unknown (it was completed or timed out before)
+    bool complete(const char* peer, uint32_t callID, CallStatus::Code status, uint8_t* response, uint16_t lenResponse) noexcept;
+    // Ends a call whose request could not be queued
+    void cancel(uint32_t callID) noexcept;
+    // Ends every call whose deadline is not later than "now" (micro seconds) with "TimedOut"
+    void expire(uint64_t now) noexcept;
+    // The earliest deadline of the calls (micro seconds), UINT64_MAX if there is no call
+    uint64_t nextDeadline() noexcept;
+    CallStats getStats() noexcept;
+};
+
+#endif //_CSO_CONNECTOR_CALL_TABLE_H_
@@ -3,47 +3,124 @@
 
 #include <atomic>
 #include "interface.h"
+#include "pacer.h"
+#include "run_loop.h"
+#include "dispatcher.h"
+#include "call_table.h"
+#include "subscription_table.h"
+#include "send_window.h"
+#include "reassembler.h"
+#include "outbound_transfer.h"
+#include "connector_options.h"
 #include "config/config.h"
 #include "cso_queue/item.h"
 #include "cso_queue/interface.h"
 #include "cso_proxy/interface.h"
 #include "cso_parser/interface.h"
 #include "cso_counter/interface.h"
+#include "cso_counter/sender_counter.h"
+#include "cso_connection/poller.h"
 #include "cso_connection/interface.h"
+#include "synchronization/spin_lock.h"
 
 class Connector : public IConnector {
 private:
-    uint64_t time;
+    // "Done" ack of a received message which waits to be written
+    class PendingAck {
+    public:
+        uint64_t msgID;
+        uint64_t msgTag;
+        char name[MAX_CONNECTION_NAME_LENGTH + 1];
+        bool isEncrypted;
+    };
+
+    // Stage of the connection, "isActivated" is its copy for other tasks
+    RunLoop runLoop;
+    SendWindow sendWindow;
     std::atomic<bool> isActivated;
-    std::atomic<bool> isDisconnected;
     ServerTicket serverTicket;
     std::unique_ptr<IProxy> proxy;
     std::unique_ptr<IParser> parser;
     std::shared_ptr<IConfig> config;
     std::unique_ptr<ICounter> counter;
+    std::unique_ptr<SenderCounter> senderCounter;
     std::unique_ptr<IConnection> conn;
     std::unique_ptr<IQueue> queueMessages;
+    // Optional, callbacks run inline if it is nullptr
+    std::unique_ptr<Dispatcher> dispatcher;
+    // Keeps writes under the rate limit
+    std::unique_ptr<Pacer> pacer;
+    // Frames of "sendQueuedMessages", "maxAcks" + "maxFrames" of "sendWindow" are allocated once
+    std::unique_ptr<Array<uint8_t>[]> frames;
+    // Acks are only touched by "listen", "ackTime" is when the first one was queued
+    std::unique_ptr<PendingAck[]> acks;
+    uint16_t numberAcks;
+    uint64_t ackTime;
+
+    // Large messages which are received in fragments
+    std::unique_ptr<Reassembler> reassembler;
+    Error::Code (*largeMessageCallback)(const char* sender, uint8_t* data, uint32_t lenData);
+    // Large messages which are sent in fragments, "transferSpin" guards the list
+    SpinLock transferSpin;
+    OutboundTransfer* transfers;
+    std::atomic<uint32_t> nextTransferID;
+    // A fragment and its header, "maxFragmentSize" of "sendWindow" is allocated once
+    std::unique_ptr<uint8_t[]> fragment;
+
+    // Calls which are waiting for a response
+    std::unique_ptr<CallTable> calls;
+    Error::Code (*callHandler)(const char* sender, uint8_t* data, uint16_t lenData, Array<uint8_t>& response);
+    // Responses are only looked for after the first "call"
+    std::atomic<bool> isCalling;
+    // Handlers of groups and senders
+    std::unique_ptr<SubscriptionTable> subscriptions;
 
 public:
     // inits a new instance of Connector interface with default values
     static std::unique_ptr<IConnector> build(int32_t bufferSize, std::shared_ptr<IConfig> config);
 
-    // inits a new instance of Connector interface
-    static std::unique_ptr<IConnector> build(int32_t bufferSize, std::unique_ptr<IQueue> queue, std::unique_ptr<IParser> parser, std::unique_ptr<IProxy> proxy, std::shared_ptr<IConfig> config);
+    // inits a new instance of Connector interface with "options" (see "ConnectorOptions")
+    static std::unique_ptr<IConnector> build(int32_t bufferSize, ConnectorOptions options, std::shared_ptr<IConfig> config);
 
 private:
+    static std::unique_ptr<IQueue> buildQueue(int32_t bufferSize, const SendWindow& sendWindow);
+
     Connector(
-        int32_t bufferSize, 
+        const SendWindow& sendWindow,
+        std::unique_ptr<IConnection>& conn,
         std::unique_ptr<IQueue>& queue,
         std::unique_ptr<IParser>& parser,
         std::unique_ptr<IProxy>& proxy,
+        std::unique_ptr<SenderCounter>& senderCounter,
+        std::unique_ptr<Reassembler>& reassembler,
+        std::unique_ptr<CallTable>& calls,
+        std::unique_ptr<SubscriptionTable>& subscriptions,
+        std::unique_ptr<Pacer>& pacer,
+        std::unique_ptr<Dispatcher>& dispatcher,
         std::shared_ptr<IConfig>& config
     );
 
     Error::Code prepare();
+    void connect();
+    void disconnect(Error::Code error);
     Error::Code activateConnection(uint16_t ticketID, uint8_t* ticketBytes, uint16_t lenTicket);
+    Error::Code deliverMessage(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData), const char* sender, uint8_t* data, uint16_t lenData);
+    Error::Code routeMessage(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData), bool isGroup, const char* name, uint8_t* data, uint16_t lenData);
+    Error::Code deliverFragment(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData), const char* sender, uint8_t* data, uint16_t lenData);
+    bool isCallMessage(const uint8_t* data, uint16_t lenData);
+    Error::Code deliverCall(const char* sender, uint8_t* data, uint16_t lenData, bool isEncrypted);
+    Error::Code sendCallMessage(const char* peer, uint8_t kind, CallStatus::Code status, uint32_t callID, uint32_t timeout, const uint8_t* payload, uint16_t lenPayload, bool isEncrypted, int32_t retry, Priority::Code priority);
+    void handleMessage(Array<uint8_t>& cipher_msg, Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData));
+    void queueAck(uint64_t msgID, uint64_t msgTag, const char* name, bool isEncrypted);
+    uint16_t buildAcks(Array<uint8_t>* frames);
+    void flushAcks();
+    void sendQueuedMessages();
+    void queueFragments();
+    static void completeFragment(uint64_t msgID, SendStatus::Code status, void* context);
+    Result<uint64_t> doSendLargeMessage(const char* recvName, const uint8_t* content, uint32_t lenContent, bool isGroup, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority);
+    Result<Array<uint8_t>> buildMessageNotRetry(const char* name, uint8_t* content, uint16_t lenContent, bool isGroup, bool isEncrypted, bool isCache);
     Error::Code doSendMessageNotRetry(const char* name, uint8_t* content, uint16_t lenContent, bool isGroup,bool isEncrypted, bool isCache);
-    Error::Code doSendMessageRetry(const char* recvName, uint8_t* content, uint16_t lenContent, bool isGroup,bool isEncrypted, int32_t retry);
+    Result<uint64_t> doSendMessageRetry(const char* recvName, uint8_t* content, uint16_t lenContent, bool isGroup,bool isEncrypted, int32_t retry, Priority::Code priority, uint32_t ttl, SendCallback onComplete, void* context);
 
 public:
     Connector() = delete;
@@ -53,13 +130,31 @@ public:
 
     ~Connector() noexcept;
 
-    void loopReconnect();
+    void run(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData));
     void listen(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData));
+    void listen(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData), uint32_t timeout);
+    uint32_t getWaitTime(uint32_t timeout);
 
     Error::Code sendMessage(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, bool isCache);
     Error::Code sendGroupMessage(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, bool isCache);
-    Error::Code sendMessageAndRetry(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry);
-    Error::Code sendGroupMessageAndRetry(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry);
+    Error::Code sendMessageAndRetry(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, Priority::Code priority = Priority::Normal, uint32_t ttl = 0);
+    Error::Code sendGroupMessageAndRetry(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, Priority::Code priority = Priority::Normal, uint32_t ttl = 0);
+    Error::Code sendMessages(const OutboundMessage* messages, uint16_t numberMessages);
+    Error::Code sendMessagesAndRetry(const OutboundMessage* messages, uint16_t numberMessages, int32_t retry, Priority::Code priority = Priority::Normal, uint32_t ttl = 0);
+    Result<uint64_t> sendLargeMessage(const char* recvName, const uint8_t* content, uint32_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority = Priority::Bulk);
+    Result<uint64_t> sendGroupLargeMessage(const char* groupName, const uint8_t* content, uint32_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority = Priority::Bulk);
+    void setLargeMessageCallback(Error::Code (*cb)(const char* sender, uint8_t* data, uint32_t lenData));
+    Result<uint64_t> sendMessageAsync(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority = Priority::Normal, uint32_t ttl = 0);
+    Result<uint64_t> sendGroupMessageAsync(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority = Priority::Normal, uint32_t ttl = 0);
+    Result<uint32_t> call(const char* peer, const uint8_t* request, uint16_t lenRequest, bool isEncrypted, int32_t retry, uint32_t timeout, CallCallback onComplete, void* context, Priority::Code priority = Priority::High);
+    void setCallHandler(Error::Code (*handler)(const char* sender, uint8_t* data, uint16_t lenData, Array<uint8_t>& response));
+    CallStats getCallStats();
+    Result<uint32_t> subscribeGroup(const char* groupName, MessageHandler handler, void* context);
+    Result<uint32_t> subscribeSender(const char* sender, MessageHandler handler, void* context);
+    void unsubscribe(uint32_t subscriptionID);
+
+    LaneStats getLaneStats(Priority::Code priority);
+    CongestionStats getCongestionStats();
 };
 
 #endif //_CSO_CONNECTOR_H_
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef _CSO_CONNECTOR_CONNECTOR_OPTIONS_H_
+#define _CSO_CONNECTOR_CONNECTOR_OPTIONS_H_
+
+#include <memory>
+#include "pacer.h"
+#include "dispatcher.h"
+#include "call_table.h"
+#include "rate_limit.h"
+#include "send_window.h"
+#include "reassembler.h"
+#include "subscription_table.h"
+#include "cso_queue/interface.h"
+#include "cso_proxy/interface.h"
+#include "cso_parser/interface.h"
+#include "cso_counter/sender_counter.h"
+#include "cso_connection/poller.h"
+
+// ConnectorOptions are what "Connector::build" can change, any of them can be combined.
+// A part which is nullptr is built by "Connector::build" with its defaults
+class ConnectorOptions {
+public:
+    SendWindow sendWindow;
+    // Used if "pacer" is nullptr
+    RateLimit rateLimit;
+    // Callbacks of "listen" run inline if it is nullptr
+    std::unique_ptr<Dispatcher> dispatcher;
+    // Shared with other connectors (see "ConnectorPool"), the connection has its own if it is nullptr
+    std::shared_ptr<Poller> poller;
+
+    std::unique_ptr<IQueue> queue;
+    std::unique_ptr<IParser> parser;
+    std::unique_ptr<IProxy> proxy;
+    std::unique_ptr<SenderCounter> senderCounter;
+    std::unique_ptr<Reassembler> reassembler;
+    std::unique_ptr<CallTable> calls;
+    std::unique_ptr<SubscriptionTable> subscriptions;
+    std::unique_ptr<Pacer> pacer;
+
+public:
+    ConnectorOptions() noexcept;
+    ConnectorOptions(ConnectorOptions&& other) = default;
+    ConnectorOptions(const ConnectorOptions& other) = delete;
+    ConnectorOptions& operator=(const ConnectorOptions& other) = delete;
+};
+
+#endif // _CSO_CONNECTOR_CONNECTOR_OPTIONS_H_
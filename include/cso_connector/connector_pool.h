@@ -0,0 +1,58 @@
+#ifndef _CSO_CONNECTOR_CONNECTOR_POOL_H_
+#define _CSO_CONNECTOR_CONNECTOR_POOL_H_
+
+#include <memory>
+#include <cstdint>
+#include "interface.h"
+#include "utils/result.h"
+#include "cso_connection/poller.h"
+
+// "ConnectorPool" runs many connectors (one connection and one name each) on one task.
+// Its connectors are built with its poller ("getPoller"), so one "select" waits for all of their sockets
+// and a send on any of them wakes the task up. A step runs "listen" of every connector,
+// then the task sleeps until a socket is readable or the earliest connector is due.
+// Connecting blocks the other connectors until the hub answers.
+// On esp32 the sockets of lwip are few (CONFIG_LWIP_MAX_SOCKETS), every connector takes one,
+// the pool takes one more and a connector which reconnects takes one for the proxy
+class ConnectorPool {
+private:
+    class Member {
+    public:
+        std::unique_ptr<IConnector> connector;
+        Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData);
+    };
+
+    std::shared_ptr<Poller> poller;
+    std::unique_ptr<Member[]> members;
+    uint16_t maxConnectors;
+    uint16_t numberConnectors;
+
+public:
+    static std::unique_ptr<ConnectorPool> build(uint16_t maxConnectors);
+
+private:
+    ConnectorPool(uint16_t maxConnectors);
+
+public:
+    ConnectorPool() = delete;
+    ConnectorPool(ConnectorPool&& other) = delete;
+    ConnectorPool(const ConnectorPool& other) = delete;
+    ConnectorPool& operator=(const ConnectorPool& other) = delete;
+
+    ~ConnectorPool() noexcept;
+
+    // Connectors of the pool should be built with it ("poller" of "ConnectorOptions")
+    std::shared_ptr<Poller> getPoller() noexcept;
+    // Messages of "connector" are given to "cb", returns the index of "connector" for "get".
+    // Should be called before "listen"
+    Result<uint16_t> add(std::unique_ptr<IConnector> connector, Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData));
+    IConnector* get(uint16_t idx) noexcept;
+    uint16_t getNumberConnectors() noexcept;
+
+    // Sleeps at most "timeout" (milli seconds) until a connector has work, then runs "listen" of every connector
+    void listen(uint32_t timeout);
+    // Runs "listen" on the calling task forever
+    void run();
+};
+
+#endif // _CSO_CONNECTOR_CONNECTOR_POOL_H_
@@ -0,0 +1,192 @@
+#ifndef _CSO_CONNECTOR_COROUTINE_H_
+#define _CSO_CONNECTOR_COROUTINE_H_
+
+// Awaitable API of "IConnector" for C++20 builds (the host build), it is empty on older standards.
+// The awaitables wrap the asynchronous sends, "call" and the subscriptions, so they run on the task
+// which runs "listen": a coroutine is resumed by the callback which completes its awaitable.
+// Coroutines should also be started on that task, then every session runs on one thread
+// and none of them needs a lock.
+//
+//     Task session(IConnector& connector, Inbox& inbox) {
+//         Inbox::Message request = co_await inbox.receive();
+//         CallResult response = co_await awaitCall(connector, "peer", data, lenData, false, 3, 1000);
+//         SendResult result = co_await awaitSend(connector, request.sender, data, lenData, false, 3);
+//     }
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <atomic>
+#include <memory>
+#include <coroutine>
+#include "interface.h"
+#include "message/define.h"
+
+// "Task" is a coroutine which runs until its first "co_await" at once and frees itself at its end.
+// Nothing waits for it, it keeps its results in its own state
+class Task {
+public:
+    class promise_type {
+    public:
+        Task get_return_object() noexcept { return Task(); }
+        std::suspend_never initial_suspend() noexcept { return std::suspend_never(); }
+        std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept;
+    };
+};
+
+// Completion of an awaitable, the callback and "await_suspend" may run on different tasks,
+// whichever comes second goes on with the coroutine
+class Completion {
+private:
+    enum State : uint8_t {
+        Started = 0,
+        Suspended,
+        Done,
+    };
+
+    std::atomic<uint8_t> state;
+    std::coroutine_handle<> handle;
+
+public:
+    Completion() noexcept;
+
+    // Returns false if the callback was called already, the coroutine goes on without suspending
+    bool suspend(std::coroutine_handle<> handle) noexcept;
+    void complete() noexcept;
+};
+
+// Result of "awaitSend", "msgID" is 0 if the message was not queued
+class SendResult {
+public:
+    uint64_t msgID;
+    SendStatus::Code status;
+};
+
+class SendAwaiter {
+private:
+    IConnector& connector;
+    const char* recvName;
+    uint8_t* content;
+    uint16_t lenContent;
+    bool isGroup;
+    bool isEncrypted;
+    int32_t retry;
+    Priority::Code priority;
+    uint32_t ttl;
+    Completion completion;
+    SendResult result;
+
+public:
+    SendAwaiter(IConnector& connector, const char* recvName, uint8_t* content, uint16_t lenContent, bool isGroup, bool isEncrypted, int32_t retry, Priority::Code priority, uint32_t ttl) noexcept;
+    SendAwaiter(SendAwaiter&& other) = delete;
+    SendAwaiter(const SendAwaiter& other) = delete;
+    SendAwaiter& operator=(const SendAwaiter& other) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle) noexcept;
+    SendResult await_resume() noexcept { return this->result; }
+
+private:
+    static void complete(uint64_t msgID, SendStatus::Code status, void* context);
+};
+
+// Result of "awaitCall", "response" is empty if "status" is not "Replied"
+class CallResult {
+public:
+    uint32_t callID;
+    CallStatus::Code status;
+    Array<uint8_t> response;
+};
+
+class CallAwaiter {
+private:
+    IConnector& connector;
+    const char* peer;
+    const uint8_t* request;
+    uint16_t lenRequest;
+    bool isEncrypted;
+    int32_t retry;
+    uint32_t timeout;
+    Priority::Code priority;
+    Completion completion;
+    CallResult result;
+
+public:
+    CallAwaiter(IConnector& connector, const char* peer, const uint8_t* request, uint16_t lenRequest, bool isEncrypted, int32_t retry, uint32_t timeout, Priority::Code priority) noexcept;
+    CallAwaiter(CallAwaiter&& other) = delete;
+    CallAwaiter(const CallAwaiter& other) = delete;
+    CallAwaiter& operator=(const CallAwaiter& other) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle) noexcept;
+    CallResult await_resume() noexcept { return std::move(this->result); }
+
+private:
+    static void complete(uint32_t callID, CallStatus::Code status, uint8_t* response, uint16_t lenResponse, void* context);
+};
+
+// "Inbox" subscribes a group or a sender and keeps its messages until a coroutine receives them.
+// A message which does not fit is not acknowledged ("CSOConnector_InboxFull"), its sender retries it.
+// It is not thread safe, the coroutines which receive run on the task of "listen".
+// It has to live longer than its waiting coroutine
+class Inbox {
+public:
+    class Message {
+    public:
+        char sender[MAX_CONNECTION_NAME_LENGTH + 1];
+        Array<uint8_t> data;
+    };
+
+    class ReceiveAwaiter {
+    private:
+        Inbox& inbox;
+
+    public:
+        ReceiveAwaiter(Inbox& inbox) noexcept : inbox(inbox) {}
+
+        bool await_ready() const noexcept { return this->inbox.numberMessages > 0; }
+        void await_suspend(std::coroutine_handle<> handle) noexcept { this->inbox.waiter = handle; }
+        Message await_resume() noexcept { return this->inbox.pop(); }
+    };
+
+private:
+    IConnector& connector;
+    uint32_t subscriptionID;
+    // Ring of received messages
+    std::unique_ptr<Message[]> messages;
+    uint16_t capacity;
+    uint16_t head;
+    uint16_t numberMessages;
+    // Only one coroutine waits at a time
+    std::coroutine_handle<> waiter;
+
+public:
+    static std::unique_ptr<Inbox> build(IConnector& connector, bool isGroup, const char* name);
+    static std::unique_ptr<Inbox> build(IConnector& connector, bool isGroup, const char* name, uint16_t capacity);
+
+private:
+    Inbox(IConnector& connector, bool isGroup, const char* name, uint16_t capacity);
+
+    Message pop() noexcept;
+    static Error::Code handle(const char* sender, uint8_t* data, uint16_t lenData, void* context);
+
+public:
+    Inbox() = delete;
+    Inbox(Inbox&& other) = delete;
+    Inbox(const Inbox& other) = delete;
+    Inbox& operator=(const Inbox& other) = delete;
+
+    ~Inbox() noexcept;
+
+    ReceiveAwaiter receive() noexcept;
+};
+
+// "co_await" gives a "SendResult", the message is acked, expired, exhausted or could not be queued
+SendAwaiter awaitSend(IConnector& connector, const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, Priority::Code priority = Priority::Normal, uint32_t ttl = 0) noexcept;
+SendAwaiter awaitSendGroup(IConnector& connector, const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, Priority::Code priority = Priority::Normal, uint32_t ttl = 0) noexcept;
+// "co_await" gives a "CallResult" when the response is received, the call failed or timed out
+CallAwaiter awaitCall(IConnector& connector, const char* peer, const uint8_t* request, uint16_t lenRequest, bool isEncrypted, int32_t retry, uint32_t timeout, Priority::Code priority = Priority::High) noexcept;
+
+#endif
+
+#endif // _CSO_CONNECTOR_COROUTINE_H_
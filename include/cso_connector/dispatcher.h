@@ -0,0 +1,73 @@
+#ifndef _CSO_CONNECTOR_DISPATCHER_H_
+#define _CSO_CONNECTOR_DISPATCHER_H_
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include "utils/array.h"
+#include "error/error_code.h"
+#include "synchronization/semaphore.h"
+#include "synchronization/concurrency_queue.h"
+
+#ifndef ESP_PLATFORM
+#include <thread>
+#include <vector>
+#endif
+
+// A received message which waits for its callback
+class Delivery {
+public:
+    Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData);
+    // "content" is the sender name ('\0' terminated) followed by the data
+    Array<uint8_t> content;
+    uint16_t lenData;
+
+public:
+    Delivery() noexcept;
+    Delivery(Delivery&& other) noexcept;
+    Delivery(const Delivery& other) = delete;
+    Delivery& operator=(const Delivery& other) = delete;
+    Delivery& operator=(Delivery&& other) noexcept;
+};
+
+// "Dispatcher" runs callbacks of "listen" out of the task of "listen",
+// so a slow callback does not hold back "Done" acks and sending.
+// On esp32 one worker task is pinned to the other core ("numberWorkers" has to be 1),
+// on the host "numberWorkers" threads share the queue.
+// Every queued message gives one notification, so it wakes up a worker which is idle.
+// A message is acknowledged when it is queued, the error of its callback is ignored.
+class Dispatcher {
+private:
+    ConcurrencyQueue<Delivery> deliveries;
+    Semaphore deliverySignal;
+    std::atomic<bool> isStopped;
+    std::atomic<uint32_t> numberRunning;
+#ifndef ESP_PLATFORM
+    std::vector<std::thread> workers;
+#endif
+
+public:
+    static std::unique_ptr<Dispatcher> build(uint32_t queueSize);
+    static std::unique_ptr<Dispatcher> build(uint32_t queueSize, uint8_t numberWorkers);
+
+private:
+    Dispatcher(uint32_t queueSize, uint8_t numberWorkers);
+
+    static void runWorker(void* param);
+    void loopDispatch() noexcept;
+
+public:
+    Dispatcher() = delete;
+    Dispatcher(Dispatcher&& other) = delete;
+    Dispatcher(const Dispatcher& other) = delete;
+    Dispatcher& operator=(const Dispatcher& other) = delete;
+
+    // Waits until workers finish their callbacks, messages in queue are dropped
+    ~Dispatcher() noexcept;
+
+    // Copies "sender" and "data" and queues the callback
+    // Returns "Synchronization_ConcurrencyQueue_Full" if workers are too far behind
+    Error::Code dispatch(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData), const char* sender, const uint8_t* data, uint16_t lenData) noexcept;
+};
+
+#endif //_CSO_CONNECTOR_DISPATCHER_H_
@@ -1,19 +1,97 @@
 #ifndef _CSO_CONNECTOR_INTERFACE_H_
 #define _CSO_CONNECTOR_INTERFACE_H_
 
+#include "utils/array.h"
+#include "utils/result.h"
 #include "error/error_code.h"
+#include "cso_queue/priority.h"
+#include "cso_queue/lane_stats.h"
+#include "cso_queue/congestion_stats.h"
+#include "cso_queue/send_status.h"
+#include "call_stats.h"
+#include "call_status.h"
+#include "message_handler.h"
+#include "outbound_message.h"
 
 class IConnector {
 public:
-    // "loopReconnect" should be called in core 1 of esp32
-    virtual void loopReconnect() = 0;
-    // "listen" should be called in core 0 of esp32
+    virtual ~IConnector() noexcept {}
+
+    // Runs "listen" on the calling task forever, it sleeps until there is work to do.
+    // One task runs the connector, "listen" should not be called by another one
+    virtual void run(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData)) = 0;
+    // Does one step of the connector: connects or reconnects (with a backoff) and activates the connection
+    // when it is due, receives messages, sends queued messages and acks, and times out calls.
+    // Connecting blocks until the hub answers
     virtual void listen(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData)) = 0;
+    // Same as "listen" but sleeps first until the socket is readable, a message is sent, the next
+    // connect, activation, retry or call deadline is due, or "timeout" (milli seconds) expires,
+    // so the caller does not need to poll
+    virtual void listen(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData), uint32_t timeout) = 0;
+    // Time (milli seconds) until the next step of "listen" is due, at most "timeout", 0 if it is due now.
+    // It does not know the socket, see "ConnectorPool"
+    virtual uint32_t getWaitTime(uint32_t timeout) = 0;
 
+    // Over the rate limit (see "RateLimit") the message waits for "listen" in a small buffer,
+    // "CSOConnector_RateLimited" is returned if the buffer is full
     virtual Error::Code sendMessage(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, bool isCache) = 0;
     virtual Error::Code sendGroupMessage(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, bool isCache) = 0;
-    virtual Error::Code sendMessageAndRetry(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry) = 0;
-    virtual Error::Code sendGroupMessageAndRetry(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry) = 0;
+    // "ttl" (milli seconds) is how long the message stays useful, 0 if it never expires
+    virtual Error::Code sendMessageAndRetry(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, Priority::Code priority = Priority::Normal, uint32_t ttl = 0) = 0;
+    virtual Error::Code sendGroupMessageAndRetry(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, Priority::Code priority = Priority::Normal, uint32_t ttl = 0) = 0;
+    // Sends "numberMessages" messages in one write, nothing is sent if a message can not be built.
+    // The rate limit applies to every message, the first rejected one gives "CSOConnector_RateLimited"
+    virtual Error::Code sendMessages(const OutboundMessage* messages, uint16_t numberMessages) = 0;
+    // Queues all messages or none of them ("CSOConnector_MessageQueueFull" or an invalid message).
+    // Only "NotEnoughMemory" for a large content can leave the earlier messages queued. "isCached" is ignored
+    virtual Error::Code sendMessagesAndRetry(const OutboundMessage* messages, uint16_t numberMessages, int32_t retry, Priority::Code priority = Priority::Normal, uint32_t ttl = 0) = 0;
+    // Same as "sendMessageAndRetry" but returns the ID of the message as a handle.
+    // "onComplete" is called once with the handle and "context": on "listen" when the message is acked, expires
+    // or runs out of retries, or at once with "QueueFull" or "Dropped" if it can not be queued (handle 0)
+    virtual Result<uint64_t> sendMessageAsync(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority = Priority::Normal, uint32_t ttl = 0) = 0;
+    virtual Result<uint64_t> sendGroupMessageAsync(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority = Priority::Normal, uint32_t ttl = 0) = 0;
+
+    // Splits "content" into fragments of "maxFragmentSize" (see "SendWindow"), "listen" queues them
+    // while the queue has room and every fragment is acknowledged and retried by itself.
+    // Returns the ID of the transfer as a handle, "onComplete" is called once with it and "context"
+    // after the last fragment ("Acked") or the first failed fragment.
+    // "content" is not copied, it has to live until "onComplete" is called
+    virtual Result<uint64_t> sendLargeMessage(const char* recvName, const uint8_t* content, uint32_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority = Priority::Bulk) = 0;
+    virtual Result<uint64_t> sendGroupLargeMessage(const char* groupName, const uint8_t* content, uint32_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority = Priority::Bulk) = 0;
+    // Large messages are given to "cb" after they are reassembled, it runs on the task of "listen".
+    // Without it, large messages up to 65535 bytes are given to the callback of "listen"
+    // Should be called before "listen"
+    virtual void setLargeMessageCallback(Error::Code (*cb)(const char* sender, uint8_t* data, uint32_t lenData)) = 0;
+
+    // Sends "request" to "peer" and waits for the response without blocking, "request" is copied.
+    // Returns the ID of the call as a handle, "onComplete" is called once with it, the response and "context":
+    // on "listen" when the response is received ("Replied"), the handler of "peer" returned an error ("Failed")
+    // or "timeout" (milli seconds) passed ("TimedOut"), or at once with "Dropped" if the request can not be queued.
+    // "timeout" is also the "ttl" of the request, a call with "timeout" 0 is rejected
+    virtual Result<uint32_t> call(const char* peer, const uint8_t* request, uint16_t lenRequest, bool isEncrypted, int32_t retry, uint32_t timeout, CallCallback onComplete, void* context, Priority::Code priority = Priority::High) = 0;
+    // Requests of "call" are given to "handler" instead of the callback of "listen", it runs on the task of "listen".
+    // "response" is sent back to the caller if "handler" returns "Error::Nil", otherwise the call fails.
+    // Calls are opt-in on both ends: after "call", messages of a peer which start with the header of a response
+    // are taken as responses, after "setCallHandler" the ones with the header of a request (see "CallTable").
+    // Group messages are never calls
+    // Should be called before "listen"
+    virtual void setCallHandler(Error::Code (*handler)(const char* sender, uint8_t* data, uint16_t lenData, Array<uint8_t>& response)) = 0;
+    // Counters and latency histogram of "call"
+    virtual CallStats getCallStats() = 0;
+
+    // Messages of group "groupName" are given to "handler" instead of the callback of "listen",
+    // a group can have many handlers, they run on the task of "listen" in the order they subscribed.
+    // If a handler returns an error the message is not acknowledged, all handlers get it again with its retry.
+    // Returns the ID of the subscription for "unsubscribe"
+    virtual Result<uint32_t> subscribeGroup(const char* groupName, MessageHandler handler, void* context) = 0;
+    // Same as "subscribeGroup" for messages which "sender" sends to this connection
+    virtual Result<uint32_t> subscribeSender(const char* sender, MessageHandler handler, void* context) = 0;
+    virtual void unsubscribe(uint32_t subscriptionID) = 0;
+
+    // Stats of a priority lane in the queue of "sendMessageAndRetry" and "sendGroupMessageAndRetry"
+    virtual LaneStats getLaneStats(Priority::Code priority) = 0;
+    // Window of messages in flight of the queue, see "isCongestionControlled" of "SendWindow"
+    virtual CongestionStats getCongestionStats() = 0;
 };
 
 #endif //_CSO_CONNECTOR_INTERFACE_H_
\ No newline at end of file
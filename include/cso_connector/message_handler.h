@@ -0,0 +1,11 @@
+#ifndef _CSO_CONNECTOR_MESSAGE_HANDLER_H_
+#define _CSO_CONNECTOR_MESSAGE_HANDLER_H_
+
+#include <cstdint>
+#include "error/error_code.h"
+
+// Handler of "subscribeGroup" and "subscribeSender",
+// "context" is the pointer given together with the handler
+typedef Error::Code (*MessageHandler)(const char* sender, uint8_t* data, uint16_t lenData, void* context);
+
+#endif // _CSO_CONNECTOR_MESSAGE_HANDLER_H_
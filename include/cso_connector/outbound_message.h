@@ -0,0 +1,24 @@
+#ifndef _CSO_CONNECTOR_OUTBOUND_MESSAGE_H_
+#define _CSO_CONNECTOR_OUTBOUND_MESSAGE_H_
+
+#include <cstdint>
+
+// OutboundMessage is a message of "sendMessages" and "sendMessagesAndRetry".
+// "recvName" and "content" are not copied, they have to live until the call returns
+class OutboundMessage {
+public:
+    // Name of the receiver, or name of the group if "isGroup" is true
+    const char* recvName;
+    uint8_t* content;
+    uint16_t lenContent;
+    bool isGroup;
+    bool isEncrypted;
+    // Only used by "sendMessages"
+    bool isCached;
+
+public:
+    OutboundMessage() noexcept;
+    OutboundMessage(const char* recvName, uint8_t* content, uint16_t lenContent, bool isGroup, bool isEncrypted, bool isCached) noexcept;
+};
+
+#endif // _CSO_CONNECTOR_OUTBOUND_MESSAGE_H_
@@ -0,0 +1,43 @@
+#ifndef _CSO_CONNECTOR_OUTBOUND_TRANSFER_H_
+#define _CSO_CONNECTOR_OUTBOUND_TRANSFER_H_
+
+#include <cstdint>
+#include "message/define.h"
+#include "cso_queue/priority.h"
+#include "cso_queue/send_status.h"
+
+// OutboundTransfer is a large message of "sendLargeMessage" which is being split into fragments.
+// Fragments are queued by "listen" while the queue has room,
+// every fragment is acknowledged and retried by itself.
+class OutboundTransfer {
+public:
+    uint32_t transferID;
+    char recvName[MAX_CONNECTION_NAME_LENGTH + 1];
+    const uint8_t* content;
+    uint32_t lenContent;
+    // Start of the next fragment
+    uint32_t offset;
+    // Fragments which are queued but not completed yet
+    uint32_t numberPending;
+    bool isGroup;
+    bool isEncrypted;
+    int32_t retry;
+    Priority::Code priority;
+    // "Acked" until a fragment fails
+    SendStatus::Code status;
+    SendCallback onComplete;
+    void* context;
+    // Next transfer in the list of "Connector"
+    OutboundTransfer* next;
+
+public:
+    OutboundTransfer() noexcept;
+    OutboundTransfer(OutboundTransfer&& other) = delete;
+    OutboundTransfer(const OutboundTransfer& other) = delete;
+    OutboundTransfer& operator=(const OutboundTransfer& other) = delete;
+
+    // Every fragment was queued or a fragment failed, and no fragment is pending
+    bool isDone() noexcept;
+};
+
+#endif // _CSO_CONNECTOR_OUTBOUND_TRANSFER_H_
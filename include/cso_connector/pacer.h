@@ -0,0 +1,86 @@
+#ifndef _CSO_CONNECTOR_PACER_H_
+#define _CSO_CONNECTOR_PACER_H_
+
+#include <memory>
+#include <cstdint>
+#include "utils/array.h"
+#include "error/error_code.h"
+#include "message/define.h"
+#include "rate_limit.h"
+#include "token_bucket.h"
+#include "synchronization/spin_lock.h"
+
+// "Pacer" keeps the writes of "Connector" under its "RateLimit".
+// The connection has a token bucket of bytes, every recipient of an unreliable send has a bucket of messages.
+// An unreliable message over the limit waits in a small ring until "listen" takes it, or it is rejected if the ring is full.
+// Reliable messages are taken from the queue by "listen" while the connection has tokens.
+class Pacer {
+private:
+    class Recipient {
+    public:
+        char name[MAX_CONNECTION_NAME_LENGTH + 1];
+        uint32_t hash;
+        TokenBucket bucket;
+    };
+
+    class Deferred {
+    public:
+        char recvName[MAX_CONNECTION_NAME_LENGTH + 1];
+        Array<uint8_t> frame;
+    };
+
+    RateLimit rateLimit;
+    bool isLimited;
+    uint8_t maxRecipients;
+
+    // Everything below is guarded by "spin"
+    SpinLock spin;
+    TokenBucket link;
+    // Recipients are few, the least recently used one is reused for a new one
+    Recipient* recipients;
+    uint8_t numberRecipients;
+    // Ring of deferred messages, they are sent in order
+    Deferred* deferred;
+    uint16_t headDeferred;
+    uint16_t numberDeferred;
+
+public:
+    static std::unique_ptr<Pacer> build();
+    static std::unique_ptr<Pacer> build(const RateLimit& rateLimit);
+    static std::unique_ptr<Pacer> build(const RateLimit& rateLimit, uint8_t maxRecipients);
+
+private:
+    Pacer(const RateLimit& rateLimit, uint8_t maxRecipients);
+
+    static uint32_t hashName(const char* name) noexcept;
+    uint8_t findRecipient(const char* name, uint64_t now) noexcept;
+    bool hasTokens(uint8_t recipient, uint32_t lenFrame, uint64_t now) noexcept;
+    void takeTokens(uint8_t recipient, uint32_t lenFrame) noexcept;
+
+public:
+    Pacer() = delete;
+    Pacer(Pacer&& other) = delete;
+    Pacer(const Pacer& other) = delete;
+    Pacer& operator=(const Pacer& other) = delete;
+
+    ~Pacer() noexcept;
+
+    // Method can invoke on many threads.
+    // Decides if an unreliable "frame" to "recvName" is written now ("isDeferred" is false),
+    // waits for "listen" ("isDeferred" is true, "frame" is moved) or is rejected ("CSOConnector_RateLimited").
+    // Messages are never written before a message which was deferred earlier
+    Error::Code admit(const char* recvName, Array<uint8_t>& frame, bool& isDeferred) noexcept;
+    // Only "listen" invokes the methods below.
+    // Moves deferred frames which are allowed now into "frames", returns their number
+    uint16_t takeDeferred(Array<uint8_t>* frames, uint16_t maxFrames, uint32_t& bytes) noexcept;
+    // The connection has tokens for the next frame of the queue
+    bool isLinkReady() noexcept;
+    // Takes tokens of frames of the queue which were sent
+    void consumeLink(uint32_t bytes) noexcept;
+    // Time (micro seconds) when "listen" can send, "dueTime" is the next due time of the queue
+    uint64_t nextSendTime(uint64_t dueTime) noexcept;
+    // Deferred frames are built for a session, they are dropped if it is lost
+    void clearDeferred() noexcept;
+};
+
+#endif //_CSO_CONNECTOR_PACER_H_
@@ -0,0 +1,24 @@
+#ifndef _CSO_CONNECTOR_RATE_LIMIT_H_
+#define _CSO_CONNECTOR_RATE_LIMIT_H_
+
+#include <cstdint>
+
+// RateLimit bounds what "Connector" writes to the hub, a rate of 0 is unlimited
+class RateLimit {
+public:
+    // Bytes per second of the connection and the bytes which can be sent at once
+    uint32_t bytesPerSecond;
+    uint32_t burstBytes;
+    // Messages per second to a recipient (or a group) of the unreliable sends
+    uint16_t messagesPerRecipient;
+    uint16_t burstPerRecipient;
+    // Unreliable messages over the limit which wait for "listen", the others are rejected
+    uint16_t maxDeferred;
+
+public:
+    RateLimit() noexcept;
+    RateLimit(uint32_t bytesPerSecond, uint32_t burstBytes) noexcept;
+    RateLimit(uint32_t bytesPerSecond, uint32_t burstBytes, uint16_t messagesPerRecipient, uint16_t burstPerRecipient, uint16_t maxDeferred) noexcept;
+};
+
+#endif // _CSO_CONNECTOR_RATE_LIMIT_H_
@@ -0,0 +1,68 @@
+#ifndef _CSO_CONNECTOR_REASSEMBLER_H_
+#define _CSO_CONNECTOR_REASSEMBLER_H_
+
+#include <memory>
+#include <cstdint>
+#include "error/error_code.h"
+#include "message/define.h"
+
+// Every fragment of a large message starts with
+// transferID(4) | lenMessage(4) | offset(4), followed by a part of the message
+#define FRAGMENT_HEADER_SIZE 12
+
+// "Reassembler" joins the fragments of large messages (see "sendLargeMessage").
+// Fragments can come in any order, a message is complete when all of its bytes are received.
+// Every entry has a bitmap of its received bytes, so retried or overlapping fragments are counted once.
+// At most "capacity" messages are joined at a time,
+// a message which gets no fragment during "timeout" is dropped for a new one.
+class Reassembler {
+private:
+    class Entry {
+    public:
+        char sender[MAX_CONNECTION_NAME_LENGTH + 1];
+        uint32_t transferID;
+        // nullptr if the entry is unused
+        uint8_t* content;
+        // A bit per byte of "content"
+        uint32_t* receivedBits;
+        uint32_t lenContent;
+        uint32_t lenReceived;
+        uint64_t updateTime;
+    };
+
+    uint8_t capacity;
+    uint32_t maxMessageSize;
+    uint64_t timeout;
+    Entry* entries;
+
+public:
+    static std::unique_ptr<Reassembler> build();
+    // "timeout" (milli seconds)
+    static std::unique_ptr<Reassembler> build(uint8_t capacity, uint32_t maxMessageSize, uint32_t timeout);
+
+private:
+    Reassembler(uint8_t capacity, uint32_t maxMessageSize, uint32_t timeout);
+
+    Entry* findEntry(const char* sender, uint32_t transferID, uint32_t lenMessage, uint64_t now) noexcept;
+    static uint32_t markReceived(uint32_t* receivedBits, uint32_t offset, uint32_t length, bool isReceived) noexcept;
+
+public:
+    Reassembler() = delete;
+    Reassembler(Reassembler&& other) = delete;
+    Reassembler(const Reassembler& other) = delete;
+    Reassembler& operator=(const Reassembler& other) = delete;
+
+    ~Reassembler() noexcept;
+
+    // Copies "fragment" into its message, "slot" is set to the entry of the message
+    Error::Code addFragment(const char* sender, const uint8_t* fragment, uint16_t lenFragment, uint8_t& slot) noexcept;
+    bool isComplete(uint8_t slot) noexcept;
+    uint8_t* getContent(uint8_t slot) noexcept;
+    uint32_t getLength(uint8_t slot) noexcept;
+    // Frees the message after it is delivered
+    void release(uint8_t slot) noexcept;
+    // Forgets a fragment which was added, it will be received again
+    void revertFragment(uint8_t slot, const uint8_t* fragment, uint16_t lenFragment) noexcept;
+};
+
+#endif //_CSO_CONNECTOR_REASSEMBLER_H_
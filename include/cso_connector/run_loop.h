@@ -0,0 +1,48 @@
+#ifndef _CSO_CONNECTOR_RUN_LOOP_H_
+#define _CSO_CONNECTOR_RUN_LOOP_H_
+
+#include <cstdint>
+
+// RunLoop keeps the stage of the connection of "Connector" and when its next step is due,
+// so one task does connecting, activation and reconnect backoff next to receiving and sending.
+// Failed connects wait "minBackoff" (milli seconds), twice as long after every failure up to "maxBackoff".
+// Times are micro seconds of "TIMESTAMP_MICRO_SECS".
+// It is not thread safe, only the task of "listen" touches it.
+class RunLoop {
+public:
+    enum Stage : uint8_t {
+        // Connects when "nextTime" is due
+        Offline = 0,
+        // Connected, sends the activation when "nextTime" is due
+        Activating,
+        // Receives and sends messages
+        Active,
+    };
+
+private:
+    Stage stage;
+    uint64_t nextTime;
+    uint32_t backoff;
+    uint32_t minBackoff;
+    uint32_t maxBackoff;
+
+public:
+    RunLoop() noexcept;
+    RunLoop(uint32_t minBackoff, uint32_t maxBackoff) noexcept;
+
+    Stage getStage() const noexcept;
+    // Time of the next connect or activation, UINT64_MAX if the connection is active
+    uint64_t getNextTime() const noexcept;
+    bool isDue(uint64_t now) const noexcept;
+
+    // The network is down, it is checked again soon without a backoff
+    void onNetworkDown(uint64_t now) noexcept;
+    void onConnectFailed(uint64_t now) noexcept;
+    void onConnected(uint64_t now) noexcept;
+    void onActivationSent(uint64_t now) noexcept;
+    void onActivated() noexcept;
+    // A lost connection is connected again at once, the backoff starts after that
+    void onDisconnected(uint64_t now) noexcept;
+};
+
+#endif // _CSO_CONNECTOR_RUN_LOOP_H_
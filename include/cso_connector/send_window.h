@@ -0,0 +1,30 @@
+#ifndef _CSO_CONNECTOR_SEND_WINDOW_H_
+#define _CSO_CONNECTOR_SEND_WINDOW_H_
+
+#include <cstdint>
+
+// SendWindow bounds the messages that "listen" takes from the retry queue
+class SendWindow {
+public:
+    // Maximum frames sent in one "listen" call
+    uint16_t maxFrames;
+    // Maximum bytes sent in one "listen" call (a frame is never split)
+    uint32_t maxBytes;
+    // Maximum messages which are sent but not acknowledged yet
+    uint32_t maxInFlight;
+    // An AIMD window up to "maxInFlight" limits the messages in flight (see "CongestionWindow")
+    bool isCongestionControlled;
+    // Maximum content of a fragment of "sendLargeMessage" (with the fragment header)
+    uint16_t maxFragmentSize;
+    // "Done" acks of received messages are written together when "maxAcks" are waiting
+    // or the first one has waited "ackDelay" (milli seconds)
+    uint16_t maxAcks;
+    uint32_t ackDelay;
+
+public:
+    SendWindow() noexcept;
+    SendWindow(uint16_t maxFrames, uint32_t maxBytes, uint32_t maxInFlight) noexcept;
+    SendWindow(uint16_t maxFrames, uint32_t maxBytes, uint32_t maxInFlight, uint16_t maxFragmentSize) noexcept;
+};
+
+#endif // _CSO_CONNECTOR_SEND_WINDOW_H_
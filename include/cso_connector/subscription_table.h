@@ -0,0 +1,89 @@
+#ifndef _CSO_CONNECTOR_SUBSCRIPTION_TABLE_H_
+#define _CSO_CONNECTOR_SUBSCRIPTION_TABLE_H_
+
+#include <memory>
+#include <cstdint>
+#include "utils/result.h"
+#include "error/error_code.h"
+#include "message/define.h"
+#include "message_handler.h"
+#include "synchronization/spin_lock.h"
+
+// "SubscriptionTable" routes received messages to the handlers of their group or sender.
+// A topic is a group name or a sender name, it is stored once and found by a hash index
+// (open addressing) in O(1). Every topic has a list of handlers.
+class SubscriptionTable {
+private:
+    class Topic {
+    public:
+        char name[MAX_CONNECTION_NAME_LENGTH + 1];
+        uint8_t lenName;
+        bool isGroup;
+        uint32_t hash;
+        // List of subscribers, in the order they subscribed
+        uint16_t head;
+        uint16_t tail;
+        uint16_t numberSubscribers;
+    };
+
+    class Subscriber {
+    public:
+        // 0 if the subscriber is unused
+        uint32_t subscriptionID;
+        uint16_t topic;
+        MessageHandler handler;
+        void* context;
+        uint16_t next;
+    };
+
+    uint16_t maxTopics;
+    uint16_t maxSubscribers;
+    Topic* topics;
+    Subscriber* subscribers;
+    // Handlers of a topic are copied here by "dispatch", they run without "spin"
+    Subscriber* snapshot;
+
+    // Everything below is guarded by "spin"
+    SpinLock spin;
+    // Stacks of unused indexes
+    uint16_t* freeTopics;
+    uint16_t numberFreeTopics;
+    uint16_t* freeSubscribers;
+    uint16_t numberFreeSubscribers;
+    // Index of topics, its size is a power of 2
+    uint16_t* slots;
+    uint32_t slotMask;
+    // Increases on every subscription, so an old ID never removes a new subscriber
+    uint32_t generation;
+
+public:
+    static std::unique_ptr<SubscriptionTable> build();
+    static std::unique_ptr<SubscriptionTable> build(uint16_t maxTopics, uint16_t maxSubscribers);
+
+private:
+    SubscriptionTable(uint16_t maxTopics, uint16_t maxSubscribers);
+
+    static uint32_t hashName(bool isGroup, const char* name, uint8_t lenName) noexcept;
+    uint16_t findTopic(bool isGroup, const char* name, uint8_t lenName, uint32_t hash) noexcept;
+    uint16_t addTopic(bool isGroup, const char* name, uint8_t lenName, uint32_t hash) noexcept;
+    void removeTopic(uint16_t idx) noexcept;
+
+public:
+    SubscriptionTable() = delete;
+    SubscriptionTable(SubscriptionTable&& other) = delete;
+    SubscriptionTable(const SubscriptionTable& other) = delete;
+    SubscriptionTable& operator=(const SubscriptionTable& other) = delete;
+
+    ~SubscriptionTable() noexcept;
+
+    // Method can invoke on many threads.
+    // Returns the ID of the subscription, it is never 0
+    Result<uint32_t> subscribe(bool isGroup, const char* name, MessageHandler handler, void* context) noexcept;
+    void unsubscribe(uint32_t subscriptionID) noexcept;
+    // Only one thread ("listen") can invoke it.
+    // Gives the message to every handler of its topic, "error" is the first error of the handlers.
+    // Returns false if the topic has no handler
+    bool dispatch(bool isGroup, const char* name, uint8_t* data, uint16_t lenData, Error::Code& error) noexcept;
+};
+
+#endif //_CSO_CONNECTOR_SUBSCRIPTION_TABLE_H_
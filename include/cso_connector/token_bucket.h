@@ -0,0 +1,31 @@
+#ifndef _CSO_CONNECTOR_TOKEN_BUCKET_H_
+#define _CSO_CONNECTOR_TOKEN_BUCKET_H_
+
+#include <cstdint>
+
+// TokenBucket gets "rate" tokens per second up to "burst" tokens.
+// Taking "number" tokens needs min("number", "burst") tokens, so a cost larger than "burst"
+// is possible and leaves a debt which is paid before the next one.
+// It is not thread safe.
+class TokenBucket {
+private:
+    uint32_t rate;
+    uint32_t burst;
+    // Tokens multiplied by 1000000, it is negative if there is a debt
+    int64_t credit;
+    uint64_t updateTime;
+
+public:
+    TokenBucket() noexcept;
+
+    // "rate" 0 is unlimited, "burst" is at least 1
+    void reset(uint32_t rate, uint32_t burst, uint64_t now) noexcept;
+    bool isLimited() const noexcept;
+    bool hasTokens(uint32_t number, uint64_t now) noexcept;
+    void take(uint32_t number) noexcept;
+    // Time (micro seconds) when "hasTokens" is true for "number"
+    uint64_t readyTime(uint32_t number) const noexcept;
+    uint64_t getUpdateTime() const noexcept;
+};
+
+#endif // _CSO_CONNECTOR_TOKEN_BUCKET_H_
@@ -4,22 +4,27 @@
 #include <atomic>
 #include <memory>
 #include "interface.h"
-#include "synchronization/spin_lock.h"
 
 class Counter : public ICounter {
 private:
     // Esp32 doesn't support "std::atomic<uin64_t>"
     // See more at "https://github.com/espressif/esp-idf/issues/3163"
-    SpinLock spin;
-    uint64_t writeIndex;
-    uint64_t minReadIndex;
-    uint32_t maskReadBits;
+    // A write index is "baseWriteIndex" (the high word of the first index) + an offset
+    // which is split into two lock-free 32-bit atomics:
+    //      - "lowWriteIndex" is the low word, it is increased by every writer.
+    //      - "halfEpochs" counts how many times "lowWriteIndex" crossed a half of its range,
+    //        so the high word of the offset is "halfEpochs" / 2.
+    // The addition wraps, so the first index can be near "UINT64_MAX"
+    uint64_t baseWriteIndex;
+    std::atomic<uint32_t> lowWriteIndex;
+    std::atomic<uint32_t> halfEpochs;
 
 public:
-    static std::unique_ptr<ICounter> build(uint64_t writeIndex, uint64_t minReadIndex, uint32_t maskReadBits);
+    // Read indexes are counted per sender by "SenderCounter"
+    static std::unique_ptr<ICounter> build(uint64_t writeIndex);
 
 private:
-    Counter(uint64_t writeIndex, uint64_t minReadIndex, uint32_t maskReadBits) noexcept;
+    Counter(uint64_t writeIndex) noexcept;
 
 public:
     Counter() = delete;
@@ -30,8 +35,6 @@ public:
     ~Counter() noexcept;
 
     uint64_t nextWriteIndex() noexcept;
-    void markReadUnused(uint64_t index) noexcept;
-    bool markReadDone(uint64_t index) noexcept;
 };
 
-#endif //_CSO_COUNTER_H_
\ No newline at end of file
+#endif //_CSO_COUNTER_H_
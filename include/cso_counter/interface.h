@@ -5,9 +5,9 @@
 
 class ICounter {
 public:
+    virtual ~ICounter() noexcept {}
+
     virtual uint64_t nextWriteIndex() noexcept = 0;
-    virtual void markReadUnused(uint64_t index) noexcept = 0;
-    virtual bool markReadDone(uint64_t index) noexcept = 0;
 };
 
 #endif //_CSO_COUNTER_INTERFACE_H_
\ No newline at end of file
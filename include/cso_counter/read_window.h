@@ -0,0 +1,39 @@
+#ifndef _CSO_COUNTER_READ_WINDOW_H_
+#define _CSO_COUNTER_READ_WINDOW_H_
+
+#include <cstdint>
+
+// "ReadWindow" tracks read indexes in ["minReadIndex", "minReadIndex" + "windowBits").
+// "readBits" is a ring, the bit of an index is at ("index" % "windowBits").
+// The owner allocates "readBits" ("windowBits" / 32 words).
+class ReadWindow {
+private:
+    uint64_t minReadIndex;
+    uint32_t windowBits;
+    uint32_t* readBits;
+
+public:
+    // Rounds "windowBits" to a multiple of 32 in [256, 4096]
+    static uint32_t roundWindowBits(uint32_t windowBits) noexcept;
+
+private:
+    void clearReadBits(uint64_t fromIndex, uint64_t toIndex) noexcept;
+
+public:
+    ReadWindow() noexcept;
+    ReadWindow(ReadWindow&& other) = delete;
+    ReadWindow(const ReadWindow& other) = delete;
+    ReadWindow& operator=(const ReadWindow& other) = delete;
+
+    void bind(uint32_t* readBits, uint32_t windowBits) noexcept;
+    // "maskReadBits" covers ["minReadIndex", "minReadIndex" + 32)
+    void reset(uint64_t minReadIndex, uint32_t maskReadBits) noexcept;
+
+    void markReadUnused(uint64_t index) noexcept;
+    bool markReadDone(uint64_t index) noexcept;
+    // Indexes under the window are read
+    bool isReadDone(uint64_t index) const noexcept;
+    uint64_t getMinReadIndex() const noexcept;
+};
+
+#endif //_CSO_COUNTER_READ_WINDOW_H_
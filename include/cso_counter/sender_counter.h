@@ -0,0 +1,85 @@
+#ifndef _CSO_COUNTER_SENDER_COUNTER_H_
+#define _CSO_COUNTER_SENDER_COUNTER_H_
+
+#include <memory>
+#include "read_window.h"
+#include "message/define.h"
+
+// "SenderCounter" keeps a "ReadWindow" per sender, so the tags of a sender
+// never mark the tags of another sender as read.
+// It keeps at most "capacity" senders, the least recently used one is evicted for a new one.
+// Senders are found by a hash index (open addressing) in O(1).
+// An evicted sender leaves a "Mark" of its window, so its retries are still found when it comes back.
+// Marks are kept per sender, a sender never sees the tags of another sender as read
+class SenderCounter {
+private:
+    // The last 64 indexes of the window of an evicted sender, indexes under them are read.
+    // "nextIndex" is one past the highest read index, 0 if the mark is empty
+    class Mark {
+    public:
+        uint64_t hash;
+        uint64_t nextIndex;
+        // The bit "n" is set if "nextIndex" - 1 - "n" is read
+        uint64_t readBits;
+        // "numberEvictions" when the mark was saved, the oldest mark is replaced first
+        uint32_t age;
+    };
+
+    class Entry {
+    public:
+        char name[MAX_CONNECTION_NAME_LENGTH + 1];
+        uint8_t lenName;
+        uint64_t hash;
+        // Links of the LRU list
+        uint16_t prev;
+        uint16_t next;
+        ReadWindow window;
+    };
+
+    uint16_t capacity;
+    uint16_t numberEntries;
+    uint32_t windowBits;
+    Entry* entries;
+    uint32_t* readBits;
+    // The LRU list, "head" is the most recently used entry
+    uint16_t head;
+    uint16_t tail;
+    // Index of entries, its size is a power of 2
+    uint16_t* slots;
+    uint32_t slotMask;
+    // Marks of evicted senders, a mark is in the few slots after ("hash" & "markMask").
+    // When they are all used, the oldest mark is replaced and that sender comes back as a new one
+    Mark* marks;
+    uint32_t markMask;
+    uint32_t numberEvictions;
+
+public:
+    static std::unique_ptr<SenderCounter> build();
+    static std::unique_ptr<SenderCounter> build(uint16_t capacity, uint32_t windowBits);
+
+private:
+    SenderCounter(uint16_t capacity, uint32_t windowBits);
+
+    static uint64_t hashName(const char* name, uint8_t lenName) noexcept;
+    uint16_t findEntry(const char* name, uint8_t lenName, uint64_t hash) noexcept;
+    uint16_t addEntry(const char* name, uint8_t lenName, uint64_t hash) noexcept;
+    Mark* findMark(uint64_t hash) noexcept;
+    void saveMark(uint16_t idx) noexcept;
+    void loadMark(uint16_t idx, uint64_t index) noexcept;
+    void removeSlot(uint16_t idx) noexcept;
+    void unlinkEntry(uint16_t idx) noexcept;
+    void touchEntry(uint16_t idx) noexcept;
+
+public:
+    SenderCounter() = delete;
+    SenderCounter(SenderCounter&& other) = delete;
+    SenderCounter(const SenderCounter& other) = delete;
+    SenderCounter& operator=(const SenderCounter& other) = delete;
+
+    ~SenderCounter() noexcept;
+
+    void markReadUnused(const char* sender, uint64_t index) noexcept;
+    bool markReadDone(const char* sender, uint64_t index) noexcept;
+};
+
+#endif //_CSO_COUNTER_SENDER_COUNTER_H_
@@ -0,0 +1,69 @@
+#ifndef _CSO_LOAD_LOAD_GENERATOR_H_
+#define _CSO_LOAD_LOAD_GENERATOR_H_
+
+#include <memory>
+#include <cstdint>
+#include "load_mix.h"
+#include "load_stats.h"
+#include "message/define.h"
+#include "cso_connector/interface.h"
+#include "synchronization/spin_lock.h"
+
+// "LoadGenerator" sends the traffic of a "LoadMix" to "recvName" through a real connector
+// and measures it, so the hub and the client can be sized on a device.
+// A fleet is simulated with a "ConnectorPool" which has a generator for every connector,
+// their snapshots are added up with "LoadStats::merge".
+// On Linux "test/host/load_tool" runs thousands of generators against a stand-in hub.
+// "step" runs on any task, the acks come on the task of "listen".
+// A reliable message takes an in-flight slot until its callback, a send without a free slot is rejected
+class LoadGenerator {
+private:
+    class Slot {
+    public:
+        LoadGenerator* generator;
+        uint64_t sendTime;
+        bool isUsed;
+    };
+
+    IConnector* connector;
+    char recvName[MAX_CONNECTION_NAME_LENGTH + 1];
+    LoadMix mix;
+    // Content of every message, only its length changes
+    std::unique_ptr<uint8_t[]> content;
+    uint64_t startTime;
+    uint64_t nextTime;
+    uint32_t seed;
+
+    // Everything below is guarded by "spin"
+    SpinLock spin;
+    std::unique_ptr<Slot[]> slots;
+    uint16_t maxInFlight;
+    LoadStats stats;
+
+public:
+    static std::unique_ptr<LoadGenerator> build(IConnector* connector, const char* recvName, const LoadMix& mix);
+    static std::unique_ptr<LoadGenerator> build(IConnector* connector, const char* recvName, const LoadMix& mix, uint16_t maxInFlight);
+
+private:
+    LoadGenerator(IConnector* connector, const char* recvName, const LoadMix& mix, uint16_t maxInFlight);
+
+    uint32_t nextRandom() noexcept;
+    void sendOne();
+    static void complete(uint64_t msgID, SendStatus::Code status, void* context);
+
+public:
+    LoadGenerator() = delete;
+    LoadGenerator(LoadGenerator&& other) = delete;
+    LoadGenerator(const LoadGenerator& other) = delete;
+    LoadGenerator& operator=(const LoadGenerator& other) = delete;
+
+    // The connector should not call back after the generator is destroyed
+    ~LoadGenerator() noexcept;
+
+    // Sends the messages which are due by "messagesPerSecond",
+    // returns the time (micro seconds of "TIMESTAMP_MICRO_SECS") of the next one
+    uint64_t step();
+    LoadStats getStats();
+};
+
+#endif // _CSO_LOAD_LOAD_GENERATOR_H_
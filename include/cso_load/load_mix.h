@@ -0,0 +1,28 @@
+#ifndef _CSO_LOAD_LOAD_MIX_H_
+#define _CSO_LOAD_LOAD_MIX_H_
+
+#include <cstdint>
+#include "cso_queue/priority.h"
+
+// LoadMix is the traffic which a "LoadGenerator" sends
+class LoadMix {
+public:
+    // Messages per second, 0 sends nothing
+    uint32_t messagesPerSecond;
+    // Sizes of the content are spread evenly between "minSize" and "maxSize"
+    uint16_t minSize;
+    uint16_t maxSize;
+    // Percent of the messages which are encrypted
+    uint8_t encryptedPercent;
+    // Percent of the messages which are reliable ("sendMessageAsync"), the others are sent once
+    uint8_t reliablePercent;
+    // Retries and priority of reliable messages
+    int32_t retry;
+    Priority::Code priority;
+
+public:
+    LoadMix() noexcept;
+    LoadMix(uint32_t messagesPerSecond, uint16_t minSize, uint16_t maxSize, uint8_t encryptedPercent, uint8_t reliablePercent) noexcept;
+};
+
+#endif // _CSO_LOAD_LOAD_MIX_H_
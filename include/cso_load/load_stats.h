@@ -0,0 +1,44 @@
+#ifndef _CSO_LOAD_LOAD_STATS_H_
+#define _CSO_LOAD_LOAD_STATS_H_
+
+#include <cstdint>
+
+#define NUMBER_ACK_LATENCY_BUCKETS 16
+
+// LoadStats is a snapshot of a "LoadGenerator", snapshots of many generators are added up with "merge"
+class LoadStats {
+public:
+    // Time (micro seconds) since the generator was built, the longest one after "merge"
+    uint64_t elapsed;
+    // Messages and their content bytes which the connector took
+    uint32_t numberSent;
+    uint64_t bytesSent;
+    // Messages which the connector did not take (rate limit, full queue, not activated)
+    // or which found every in-flight slot of the generator used
+    uint32_t numberRejected;
+    // Reliable messages by their end, "numberFailed" counts the expired and exhausted ones
+    uint32_t numberAcked;
+    uint32_t numberFailed;
+    uint32_t numberInFlight;
+    // Sendings of reliable messages which got no "Done" in time, taken from "LaneStats" of the connector
+    uint32_t numberRetried;
+    // Free heap (bytes) of esp32 when the snapshot was taken, the smallest one after "merge", 0 on the host
+    uint32_t freeHeap;
+    // Histogram of the ack latency from the send to "Acked", it has the buckets of "CallStats"
+    uint32_t latencyBuckets[NUMBER_ACK_LATENCY_BUCKETS];
+    uint64_t totalLatency;
+    uint64_t maxLatency;
+
+public:
+    LoadStats() noexcept;
+
+    // Adds the ack latency (micro seconds) of a message to the histogram
+    void addLatency(uint64_t latency) noexcept;
+    // Ack latency (micro seconds) below which "percent" of the acked messages are, it is the upper bound of a bucket
+    uint64_t getPercentile(uint8_t percent) const noexcept;
+    // Messages per second which the connector took
+    uint32_t getThroughput() const noexcept;
+    void merge(const LoadStats& other) noexcept;
+};
+
+#endif // _CSO_LOAD_LOAD_STATS_H_
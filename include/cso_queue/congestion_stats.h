@@ -0,0 +1,26 @@
+#ifndef _CSO_QUEUE_CONGESTION_STATS_H_
+#define _CSO_QUEUE_CONGESTION_STATS_H_
+
+#include <cstdint>
+
+// CongestionStats is a snapshot of the congestion window of "Queue"
+class CongestionStats {
+public:
+    // Messages which can be in flight now, it is "maxInFlight" without congestion control
+    uint32_t window;
+    // The largest and smallest window so far
+    uint32_t maxWindow;
+    uint32_t minWindow;
+    // Messages which are sent but not acknowledged yet
+    uint32_t numberInFlight;
+    // Acknowledgements which grew the window
+    uint32_t numberIncreases;
+    // Retries and exhausted messages, at most one of them per window shrinks it
+    uint32_t numberTimeouts;
+    uint32_t numberDecreases;
+
+public:
+    CongestionStats() noexcept;
+};
+
+#endif // _CSO_QUEUE_CONGESTION_STATS_H_
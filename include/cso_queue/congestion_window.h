@@ -0,0 +1,44 @@
+#ifndef _CSO_QUEUE_CONGESTION_WINDOW_H_
+#define _CSO_QUEUE_CONGESTION_WINDOW_H_
+
+#include <memory>
+#include <cstdint>
+#include "congestion_stats.h"
+
+// "CongestionWindow" limits the messages in flight of "Queue" by AIMD.
+// Every acknowledgement grows the window by 1 / window (by 1 per window of acknowledgements),
+// a message which has to be sent again halves it. Messages which were sent before the last
+// decrease do not shrink it again, so a burst of losses halves the window once.
+// It is not thread safe.
+class CongestionWindow {
+private:
+    uint32_t minWindow;
+    uint32_t maxWindow;
+    // The window multiplied by "WINDOW_SCALE"
+    uint32_t window;
+    uint64_t decreaseTime;
+    CongestionStats stats;
+
+public:
+    static std::unique_ptr<CongestionWindow> build(uint32_t maxWindow);
+    static std::unique_ptr<CongestionWindow> build(uint32_t initialWindow, uint32_t minWindow, uint32_t maxWindow);
+
+private:
+    CongestionWindow(uint32_t initialWindow, uint32_t minWindow, uint32_t maxWindow);
+
+    void updateStats() noexcept;
+
+public:
+    CongestionWindow() = delete;
+    CongestionWindow(CongestionWindow&& other) = delete;
+    CongestionWindow(const CongestionWindow& other) = delete;
+    CongestionWindow& operator=(const CongestionWindow& other) = delete;
+
+    uint32_t getLimit() const noexcept;
+    void onAck() noexcept;
+    // "sendTime" is the last sending of the message which got no acknowledgement in time
+    void onTimeout(uint64_t sendTime, uint64_t now) noexcept;
+    CongestionStats getStats() const noexcept;
+};
+
+#endif // _CSO_QUEUE_CONGESTION_WINDOW_H_
@@ -3,15 +3,46 @@
 
 #include "item.h"
 #include "item_ref.h"
+#include "lane_stats.h"
+#include "congestion_stats.h"
 
 class IQueue { 
 public:
+    virtual ~IQueue() noexcept {}
+
     // Method can invoke on many threads
 	// This method needs to be invoked before PushMessage method
 	virtual bool takeIndex() noexcept = 0;
-    virtual void pushMessage(ItemQueue* item) noexcept = 0;
+    // Takes "number" indexes at once, or none of them
+    virtual bool takeIndexes(uint32_t number) noexcept = 0;
+    // The index taken by "takeIndex" is given back if pushing fails.
+    // "ttl" (milli seconds) is the lifetime of the message, 0 if it has no deadline
+    // "onComplete" is called once when the message is cleared, expires or runs out of retries
+    virtual Error::Code pushMessage(
+        uint64_t msgID,
+        uint64_t msgTag,
+        const char* recvName,
+        uint8_t* content,
+        uint16_t lenContent,
+        bool isEncrypted,
+        bool isCached,
+        bool isFirst,
+        bool isLast,
+        bool isRequest,
+        bool isGroup,
+        Priority::Code priority,
+        uint32_t numberRetry,
+        uint32_t ttl,
+        SendCallback onComplete,
+        void* context
+    ) noexcept = 0;
     virtual ItemQueueRef nextMessage() noexcept = 0;
+    // Time (micro seconds, like "TIMESTAMP_MICRO_SECS") when "nextMessage" has work to do,
+    // UINT64_MAX if nothing is due until a message is pushed or cleared
+    virtual uint64_t nextDueTime() noexcept = 0;
     virtual void clearMessage(uint64_t msgID) noexcept = 0;
+    virtual LaneStats getLaneStats(Priority::Code priority) noexcept = 0;
+    virtual CongestionStats getCongestionStats() noexcept = 0;
 };
 
-#endif //_CSO_QUEUE_INTERFACE_H_
\ No newline at end of file
+#endif //_CSO_QUEUE_INTERFACE_H_
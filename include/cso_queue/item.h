@@ -1,27 +1,56 @@
 #ifndef _CSO_QUEUE_ITEM_H_
 #define _CSO_QUEUE_ITEM_H_
 
-#include <string>
 #include "utils/array.h"
+#include "message/define.h"
+#include "priority.h"
+#include "send_status.h"
 
+// "ItemQueue" lives in the slab of "Queue" for the whole life of the queue.
+// The content is copied into "inlineContent" (a part of the slab) if it fits,
+// otherwise it is copied into "overflowContent" which is allocated on the heap.
 class ItemQueue {
 public:
     uint64_t msgID;
     uint64_t msgTag;
-    std::string recvName;
-    Array<uint8_t> content;
+    char recvName[MAX_CONNECTION_NAME_LENGTH + 1];
+    uint8_t* content;
+    uint16_t lenContent;
     bool isEncrypted;
     bool isCached;
     bool isFirst;
     bool isLast;
     bool isRequest;
     bool isGroup;
+    Priority::Code priority;
     uint32_t numberRetry;
+    // Time of the last sending, 0 if the message has not been sent yet
     uint64_t timestamp;
+    // Time of pushing the message into the queue
+    uint64_t enqueueTime;
+    // The message is useless after this time, 0 if it has no deadline
+    uint64_t deadline;
+    // Called when the message leaves the queue, nullptr if nobody waits for it
+    SendCallback onComplete;
+    void* context;
+
+private:
+    uint8_t* inlineContent;
+    uint16_t lenInlineContent;
+    Array<uint8_t> overflowContent;
 
 public:
     ItemQueue() noexcept;
-    ItemQueue(
+    ItemQueue(ItemQueue&& other) = delete;
+    ItemQueue(const ItemQueue& other) = delete;
+
+    ItemQueue& operator=(const ItemQueue& other) = delete;
+    ItemQueue& operator=(ItemQueue&& other) = delete;
+
+    // Gives the item its part of the slab, it is invoked once by "Queue"
+    void bind(uint8_t* inlineContent, uint16_t lenInlineContent) noexcept;
+
+    Error::Code assign(
         uint64_t msgID,
         uint64_t msgTag,
         const char* recvName,
@@ -33,16 +62,14 @@ public:
         bool isLast,
         bool isRequest,
         bool isGroup,
+        Priority::Code priority,
         uint32_t numberRetry,
-        uint64_t timestamp
+        uint64_t enqueueTime,
+        uint64_t deadline
     ) noexcept;
-    ItemQueue(ItemQueue&& other) noexcept;
-    ItemQueue(const ItemQueue& other) = delete;
-
-    ItemQueue& operator=(const ItemQueue& other) = delete;
-    ItemQueue& operator=(ItemQueue&& other) noexcept;
 
-    Error::Code copy(const ItemQueue& other) noexcept;
+    // Frees the overflow content, the inline content is kept for the next message
+    void release() noexcept;
 };
 
-#endif //_CSO_QUEUE_ITEM_H_
\ No newline at end of file
+#endif //_CSO_QUEUE_ITEM_H_
@@ -0,0 +1,69 @@
+#ifndef _CSO_QUEUE_JOURNAL_H_
+#define _CSO_QUEUE_JOURNAL_H_
+
+#include <mutex>
+#include <cstdio>
+#include <memory>
+#include "item.h"
+#include "journal_stats.h"
+
+class IQueue;
+
+// "Journal" is an append-only log of the reliable messages in "Queue".
+// Records are batched in memory and written together (group commit),
+// so a batch is lost if the device resets before it is written.
+// "path" is a path of the VFS, e.g. "/spiffs/cso_queue.log" after "SPIFFS.begin()"
+// or "/littlefs/cso_queue.log" after "LittleFS.begin()".
+class Journal {
+private:
+    std::mutex mutex;
+    std::string path;
+    FILE* file;
+    uint8_t* batch;
+    uint32_t lenBatch;
+    uint32_t batchCapacity;
+    uint32_t batchInterval;
+    uint64_t batchTime;
+    uint32_t maxFileSize;
+    uint32_t fileSize;
+    // Messages which are appended but not cleared yet
+    uint32_t numberLive;
+    JournalStats stats;
+
+public:
+    static std::shared_ptr<Journal> build(const char* path);
+    static std::shared_ptr<Journal> build(const char* path, uint32_t batchCapacity, uint32_t batchInterval, uint32_t maxFileSize);
+
+private:
+    Journal(const char* path, uint32_t batchCapacity, uint32_t batchInterval, uint32_t maxFileSize);
+
+    void append(uint8_t type, uint64_t msgID, const uint8_t* payload, uint16_t lenPayload, const uint8_t* content, uint16_t lenContent) noexcept;
+    Error::Code writeBatch() noexcept;
+
+public:
+    Journal() = delete;
+    Journal(Journal&& other) = delete;
+    Journal(const Journal& other) = delete;
+    Journal& operator=(const Journal& other) = delete;
+
+    ~Journal() noexcept;
+
+    // Pushes messages which were not cleared into "queue"
+    Error::Code replay(IQueue* queue) noexcept;
+    // Removes all records, the file is empty after that
+    Error::Code reset() noexcept;
+
+    void appendPush(const ItemQueue& item, uint32_t ttl) noexcept;
+    void appendClear(uint64_t msgID) noexcept;
+
+    // Writes the batch if "force" is true, the batch is full or the batch is old enough
+    Error::Code sync(bool force) noexcept;
+    // Time (micro seconds) when "sync" writes the batch, UINT64_MAX if the batch is empty
+    uint64_t nextSyncTime() noexcept;
+    // The file grew over "maxFileSize", messages in queue should be appended again after "reset"
+    bool needCompact() noexcept;
+
+    JournalStats getStats() noexcept;
+};
+
+#endif // _CSO_QUEUE_JOURNAL_H_
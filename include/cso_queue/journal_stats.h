@@ -0,0 +1,21 @@
+#ifndef _CSO_QUEUE_JOURNAL_STATS_H_
+#define _CSO_QUEUE_JOURNAL_STATS_H_
+
+#include <cstdint>
+
+// JournalStats is a snapshot of the write activity of "Journal"
+class JournalStats {
+public:
+    // Messages appended to the journal
+    uint32_t numberMessages;
+    // Writes to the file (one write commits a whole batch)
+    uint32_t numberWrites;
+    // Time spent in appending messages (micro seconds)
+    uint64_t totalEnqueueTime;
+    uint64_t maxEnqueueTime;
+
+public:
+    JournalStats() noexcept;
+};
+
+#endif // _CSO_QUEUE_JOURNAL_STATS_H_
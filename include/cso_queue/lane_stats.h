@@ -0,0 +1,25 @@
+#ifndef _CSO_QUEUE_LANE_STATS_H_
+#define _CSO_QUEUE_LANE_STATS_H_
+
+#include <cstdint>
+
+// LaneStats is a snapshot of a priority lane in "Queue"
+class LaneStats {
+public:
+    // Messages in the lane
+    uint32_t depth;
+    // Messages sent the first time
+    uint32_t numberSent;
+    // Messages sent again because no "Done" came in time
+    uint32_t numberRetried;
+    // Waiting time from "pushMessage" to the first sending (micro seconds)
+    uint64_t totalWaitTime;
+    uint64_t maxWaitTime;
+    // Messages dropped because their deadline passed
+    uint32_t numberExpired;
+
+public:
+    LaneStats() noexcept;
+};
+
+#endif // _CSO_QUEUE_LANE_STATS_H_
@@ -0,0 +1,18 @@
+#ifndef _CSO_QUEUE_PRIORITY_H_
+#define _CSO_QUEUE_PRIORITY_H_
+
+#include <cstdint>
+
+#define NUMBER_PRIORITIES 3
+
+// Every priority has its own lane in "Queue"
+class Priority {
+public:
+    enum Code : uint8_t {
+        High = 0,
+        Normal,
+        Bulk,
+    };
+};
+
+#endif // _CSO_QUEUE_PRIORITY_H_
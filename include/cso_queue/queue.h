@@ -2,19 +2,60 @@
 #define _CSO_QUEUE_H_
 
 #include <atomic>
+#include <memory>
+#include "journal.h"
 #include "interface.h"
+#include "congestion_window.h"
+#include "synchronization/spin_lock.h"
 
 class Queue : public IQueue {
 private:
     uint32_t capacity;
+    uint32_t maxInFlight;
+    // Number of messages which are sent but not acknowledged yet
+    // Only "nextMessage" and "clearMessage" change it (same thread)
+    uint32_t numberInFlight;
     std::atomic<uint32_t> length;
-    std::unique_ptr<ItemQueue>* items;
+
+    // The slab: items and their inline contents are allocated once in "build"
+    ItemQueue* items;
+    uint8_t* contents;
+    std::atomic<bool>* usedItems;
+
+    // Stack of unused item indexes and stats of lanes are guarded by "spin"
+    SpinLock spin;
+    uint32_t* freeIndexes;
+    uint32_t numberFreeIndexes;
+    LaneStats laneStats[NUMBER_PRIORITIES];
+
+    // Weighted round robin between lanes, only "nextMessage" uses them
+    uint8_t laneWeights[NUMBER_PRIORITIES];
+    uint8_t laneCredits[NUMBER_PRIORITIES];
+
+    // Optional, keeps messages over a reset of the device
+    std::shared_ptr<Journal> journal;
+    // Optional, replaces "maxInFlight" by an AIMD window, guarded by "spin"
+    std::unique_ptr<CongestionWindow> congestionWindow;
 
 public:
     static std::unique_ptr<IQueue> build(uint32_t capacity);
+    static std::unique_ptr<IQueue> build(uint32_t capacity, uint32_t maxInFlight);
+    static std::unique_ptr<IQueue> build(uint32_t capacity, uint32_t maxInFlight, uint16_t lenInlineContent);
+    static std::unique_ptr<IQueue> build(uint32_t capacity, uint32_t maxInFlight, uint16_t lenInlineContent, const uint8_t laneWeights[NUMBER_PRIORITIES]);
+    static std::unique_ptr<IQueue> build(uint32_t capacity, uint32_t maxInFlight, uint16_t lenInlineContent, const uint8_t laneWeights[NUMBER_PRIORITIES], std::shared_ptr<Journal> journal);
+    static std::unique_ptr<IQueue> build(uint32_t capacity, std::unique_ptr<CongestionWindow> congestionWindow);
+    static std::unique_ptr<IQueue> build(uint32_t capacity, uint32_t maxInFlight, uint16_t lenInlineContent, const uint8_t laneWeights[NUMBER_PRIORITIES], std::shared_ptr<Journal> journal, std::unique_ptr<CongestionWindow> congestionWindow);
 
 private:
-    Queue(uint32_t capacity);
+    Queue(uint32_t capacity, uint32_t maxInFlight, uint16_t lenInlineContent, const uint8_t laneWeights[NUMBER_PRIORITIES], std::shared_ptr<Journal>& journal, std::unique_ptr<CongestionWindow>& congestionWindow);
+
+    static bool isEarlier(const ItemQueue& item, const ItemQueue& other) noexcept;
+    ItemQueue* scheduleLanes(ItemQueue* candidates[NUMBER_PRIORITIES]) noexcept;
+    uint32_t popFreeIndex() noexcept;
+    void pushFreeIndex(uint32_t idx) noexcept;
+    void removeItem(uint32_t idx, SendStatus::Code status) noexcept;
+    void compactJournal() noexcept;
+    uint32_t getInFlightLimit() noexcept;
 
 public:
     Queue() = delete;
@@ -27,9 +68,30 @@ public:
     // Method can invoke on many threads
 	// This method needs to be invoked before PushMessage method
 	bool takeIndex() noexcept;
-    void pushMessage(ItemQueue* item) noexcept;
+    bool takeIndexes(uint32_t number) noexcept;
+    Error::Code pushMessage(
+        uint64_t msgID,
+        uint64_t msgTag,
+        const char* recvName,
+        uint8_t* content,
+        uint16_t lenContent,
+        bool isEncrypted,
+        bool isCached,
+        bool isFirst,
+        bool isLast,
+        bool isRequest,
+        bool isGroup,
+        Priority::Code priority,
+        uint32_t numberRetry,
+        uint32_t ttl,
+        SendCallback onComplete,
+        void* context
+    ) noexcept;
     ItemQueueRef nextMessage() noexcept;
+    uint64_t nextDueTime() noexcept;
     void clearMessage(uint64_t msgID) noexcept;
+    LaneStats getLaneStats(Priority::Code priority) noexcept;
+    CongestionStats getCongestionStats() noexcept;
 };
 
-#endif //_CSO_QUEUE_H_
\ No newline at end of file
+#endif //_CSO_QUEUE_H_
@@ -0,0 +1,27 @@
+#ifndef _CSO_QUEUE_SEND_STATUS_H_
+#define _CSO_QUEUE_SEND_STATUS_H_
+
+#include <cstdint>
+
+// The end of a reliable message
+class SendStatus {
+public:
+    enum Code : uint8_t {
+        // The receiver sent "Done"
+        Acked = 0,
+        // The deadline passed before "Done"
+        Expired,
+        // Every retry was sent without "Done"
+        Exhausted,
+        // The queue had no unused item
+        QueueFull,
+        // The message could not be queued for other reasons
+        Dropped,
+    };
+};
+
+// "msgID" is the handle returned by the asynchronous send,
+// "context" is the pointer given to the send together with the callback
+typedef void (*SendCallback)(uint64_t msgID, SendStatus::Code status, void* context);
+
+#endif // _CSO_QUEUE_SEND_STATUS_H_
@@ -42,12 +42,21 @@ public:
         CSOProxy_InvalidHubAddress  = 0xFF000021U,
 
         // CSO_Connection has a code range from 41 to 50
-        CSOConnection_Disconnected = 0xFF000029U,
-        CSOConnection_SetupFailed  = 0xFF00002AU,
+        CSOConnection_Disconnected  = 0xFF000029U,
+        CSOConnection_SetupFailed   = 0xFF00002AU,
+        CSOConnection_InvalidLength = 0xFF00002BU,
 
         // CSO_Connector has a code range from 51 to 60
         CSOConnector_NotActivated     = 0xFF000033U,
         CSOConnector_MessageQueueFull = 0xFF000034U,
+        CSOConnector_InvalidFragment  = 0xFF000035U,
+        CSOConnector_ReassemblyFull   = 0xFF000036U,
+        CSOConnector_CallTableFull    = 0xFF000037U,
+        CSOConnector_InvalidCall      = 0xFF000038U,
+        CSOConnector_SubscriptionFull = 0xFF000039U,
+        CSOConnector_RateLimited      = 0xFF00003AU,
+        CSOConnector_InboxFull        = 0xFF00003BU,
+        CSOConnector_PoolFull         = 0xFF00003CU,
 
         // Message has a code range from 61 to 70
         Message_InvalidBytes          = 0xFF00003DU,
@@ -56,6 +65,9 @@ public:
         // Synchronization has a code range from 71 to 80
         Synchronization_ConcurrencyQueue_Full  = 0xFF000047U,
         Synchronization_ConcurrencyQueue_Empty = 0xFF000048U,
+
+        // CSO_Queue has a code range from 81 to 90
+        CSOQueue_JournalFailed = 0xFF000051U,
     };
 
 private:
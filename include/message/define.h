@@ -6,5 +6,8 @@
 #define LENGTH_SIGN_HMAC 32
 #define LENGTH_SIGN_RSA 512
 #define LENGTH_TICKET 34
+#define MAX_CONNECTION_NAME_LENGTH 36
+// Largest header, tag, name and sign (or IV and authen tag) which "Cipher" puts around the data
+#define MAX_ENVELOPE_SIZE (18 + LENGTH_SIGN_HMAC + MAX_CONNECTION_NAME_LENGTH)
 
 #endif // _MESSAGE_DEFINE_H_
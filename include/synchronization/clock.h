@@ -0,0 +1,17 @@
+#ifndef _SYNCHRONIZATION_CLOCK_H_
+#define _SYNCHRONIZATION_CLOCK_H_
+
+#include <cstdint>
+
+// "TIMESTAMP_MICRO_SECS" is a monotonic time (micro seconds),
+// the time since boot on esp32 and the steady clock on the host
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#define TIMESTAMP_MICRO_SECS() ((uint64_t)esp_timer_get_time())
+#else
+#include <chrono>
+#define TIMESTAMP_MICRO_SECS() ((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>( \
+    std::chrono::steady_clock::now().time_since_epoch()).count())
+#endif
+
+#endif //_SYNCHRONIZATION_CLOCK_H_
@@ -1,43 +1,68 @@
 #ifndef _SYNCHRONIZATION_CONCURRENCY_QUEUE_H_
 #define _SYNCHRONIZATION_CONCURRENCY_QUEUE_H_
 
+#include <new>
 #include <atomic>
 #include <memory>
 #include <cstdint>
 #include <type_traits>
-#include "spin_lock.h"
 #include "utils/result.h"
 #include "error/error_code.h"
 
+// Keeps "index_read" and "index_write" in different cache lines
+#define CACHE_LINE_SIZE 64
+// Number of values which "drain" claims at a time
+#define DRAIN_BATCH_SIZE 8
+
 // "ConcurrencyQueue" is general class for any type.
 // Except raw pointer (can implement but not necessary yet)
+// It is a bounded lock-free queue for many producers and many consumers
+// (see "http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue").
+// Every cell has a sequence number which tells whether it is ready for
+// the producer of a position ("sequence" == position)
+// or for the consumer of a position ("sequence" == position + 1).
 template<typename ValueType>
 class ConcurrencyQueue {
 private:
     // "std::aligned_storage" fix struct alignment
     using storage = typename std::aligned_storage<sizeof(ValueType), alignof(ValueType)>::type;
+
+    struct Cell {
+        std::atomic<uint32_t> sequence;
+        storage data;
+    };
+
     // Not necessarily using smart pointer, using raw pointer is simpler
-    storage* buffer;
-    SpinLock spin;
-    // Using "atomic" for "size" will be faster than putting "size" into "spin_lock" block
-    std::atomic<uint32_t> size;
+    Cell* buffer;
+    // "capacity" is a power of 2, so a position is mapped to a cell by "mask"
     uint32_t capacity;
-    uint32_t index_read;
-    uint32_t index_write;
+    uint32_t mask;
+    uint8_t padding_0[CACHE_LINE_SIZE];
+    std::atomic<uint32_t> index_write;
+    uint8_t padding_1[CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
+    std::atomic<uint32_t> index_read;
+    uint8_t padding_2[CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
 
 private:
-    bool syncPush(uint32_t& index) {
-        if (this->size.fetch_add(1) >= this->capacity) {
-            this->size.fetch_sub(1);
-            return false;
+    // Returns the cell which is reserved for the producer
+    Cell* syncPush(uint32_t& index) {
+        index = this->index_write.load(std::memory_order_relaxed);
+        while (true) {
+            Cell* cell = &this->buffer[index & this->mask];
+            uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(sequence - index);
+            if (diff == 0) {
+                // "index" is updated if another producer took it
+                if (this->index_write.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) {
+                    return cell;
+                }
+            } else if (diff < 0) {
+                // The consumer of the previous round has not taken the cell yet
+                return nullptr;
+            } else {
+                index = this->index_write.load(std::memory_order_relaxed);
+            }
         }
-
-        // Use "SpinLock" to guard in case multiple threads call this function together
-        this->spin.lock();
-        index = this->index_write;
-        this->index_write = (this->index_write + 1) % this->capacity;
-        this->spin.unlock();
-        return true;
     }
 
 public:
@@ -46,32 +71,45 @@ public:
     ConcurrencyQueue(const ConcurrencyQueue& other) = delete;
     ConcurrencyQueue& operator=(const ConcurrencyQueue& other) = delete;
 
+    // "capacity" is rounded up to a power of 2
     ConcurrencyQueue(uint32_t capacity) 
-        : spin(), 
-          size(0), 
-          capacity(capacity), 
-          index_read(0), 
-          index_write(0) {
-        if (this->capacity <= 0) {
+        : buffer(nullptr),
+          capacity(1),
+          mask(0),
+          index_write(0), 
+          index_read(0) {
+        if (capacity <= 0) {
             throw "[syncchronization/ConcurrencyQueue(uint32_t capacity)]Capacity has to be larger than 0";
         }
-        this->buffer = new (std::nothrow) storage[this->capacity];
+        while (this->capacity < capacity) {
+            this->capacity <<= 1;
+        }
+        this->mask = this->capacity - 1;
+
+        this->buffer = new (std::nothrow) Cell[this->capacity];
         if (this->buffer == nullptr) {
             throw "[syncchronization/ConcurrencyQueue(uint32_t capacity)]Not enough memory to create array";
         }
+        for (uint32_t idx = 0; idx < this->capacity; ++idx) {
+            this->buffer[idx].sequence.store(idx, std::memory_order_relaxed);
+        }
     }
 
     ~ConcurrencyQueue() noexcept {
+        clear();
         delete[] this->buffer;
     }
 
+    // The result may be out of date at once if other threads push or pop
+    bool empty() {
+        uint32_t index = this->index_read.load(std::memory_order_acquire);
+        uint32_t sequence = this->buffer[index & this->mask].sequence.load(std::memory_order_acquire);
+        return (int32_t)(sequence - (index + 1)) < 0;
+    }
+
+    // Pops and destroys all values
     void clear() {
-        // "fetch_add" or "fetch_sub" uses "std::memory_order_seq_cst"
-        this->size.store(0, std::memory_order_seq_cst);
-        this->spin.lock();
-        this->index_read = 0;
-        this->index_write = 0;
-        this->spin.unlock();
+        drain([](ValueType&) {});
     }
 
     // This function will be called if "ValueType" has move constructor
@@ -79,12 +117,15 @@ public:
               typename std::enable_if<std::is_nothrow_move_constructible<T>::value>::type* = nullptr>
     Error::Code push(T&& value) {
         uint32_t index;
-        if (!syncPush(index)) {
+        Cell* cell = syncPush(index);
+        if (cell == nullptr) {
             return Error::Synchronization_ConcurrencyQueue_Full;
         }
         // "std::addressof" prevents user wrong implementation "operator &"
         // User can return address of some fields of object, not object's address
-        new (static_cast<void*>(std::addressof(this->buffer[index])))T(std::move(value));
+        new (static_cast<void*>(std::addressof(cell->data)))T(std::move(value));
+        // Publish the value to consumers
+        cell->sequence.store(index + 1, std::memory_order_release);
         return Error::Nil;
     }
 
@@ -93,37 +134,111 @@ public:
               typename std::enable_if<std::is_nothrow_copy_constructible<T>::value>::type* = nullptr>
     Error::Code push(T& value) {
         uint32_t index;
-        if (!syncPush(index)) {
+        Cell* cell = syncPush(index);
+        if (cell == nullptr) {
             return Error::Synchronization_ConcurrencyQueue_Full;
         }
         // "std::addressof" prevents user wrong implementation "operator &"
         // User can return address of some fields of object, not object's address
-        new (static_cast<void*>(std::addressof(this->buffer[index])))T(value);
+        new (static_cast<void*>(std::addressof(cell->data)))T(value);
+        // Publish the value to consumers
+        cell->sequence.store(index + 1, std::memory_order_release);
         return Error::Nil;
     }
 
     Result<ValueType> pop() {
         Result<ValueType> ret(Error::Nil, ValueType());
-        // Check empty
-        if (this->size.load() == 0) {
-            ret.errorCode = Error::Synchronization_ConcurrencyQueue_Empty;
-            return ret;
+        Cell* cell;
+        uint32_t index = this->index_read.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &this->buffer[index & this->mask];
+            uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(sequence - (index + 1));
+            if (diff == 0) {
+                // "index" is updated if another consumer took it
+                if (this->index_read.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The value of this position has not been published yet
+                ret.errorCode = Error::Synchronization_ConcurrencyQueue_Empty;
+                return ret;
+            } else {
+                index = this->index_read.load(std::memory_order_relaxed);
+            }
         }
-        this->size.fetch_sub(1);
-
-        // Use "SpinLock" to guard in case multiple threads call this function together
-        this->spin.lock();
-        uint32_t index = this->index_read;
-        this->index_read = (this->index_read + 1) % this->capacity;
-        this->spin.unlock();
 
         // Get value
-        ValueType* ptr = reinterpret_cast<ValueType*>(std::addressof(this->buffer[index]));
+        ValueType* ptr = reinterpret_cast<ValueType*>(std::addressof(cell->data));
         // Use "std::swap" completely transfer ownership of the memory to the user
         // if "ValueType" is "std::share_ptr" or struct containing "std :: share_ptr" fields
         std::swap(ret.data, *ptr);
+        ptr->~ValueType();
+        // Give the cell to the producer of the next round
+        cell->sequence.store(index + this->mask + 1, std::memory_order_release);
         return ret;
     }
+
+    // Pops at most "max" values into "out", returns the number of popped values.
+    // The published values at the head are claimed by one "compare_exchange"
+    uint32_t popBatch(ValueType* out, uint32_t max) {
+        uint32_t count;
+        uint32_t index = this->index_read.load(std::memory_order_relaxed);
+        while (true) {
+            // Count the run of published cells from "index"
+            count = 0;
+            while (count < max && count <= this->mask) {
+                Cell* cell = &this->buffer[(index + count) & this->mask];
+                uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+                if (sequence != index + count + 1) {
+                    break;
+                }
+                count++;
+            }
+            if (count == 0) {
+                // Another consumer may have moved "index_read", try again from there
+                uint32_t current = this->index_read.load(std::memory_order_relaxed);
+                if (current == index) {
+                    return 0;
+                }
+                index = current;
+                continue;
+            }
+            // "index" is updated if another consumer took some of the cells
+            if (this->index_read.compare_exchange_weak(index, index + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (uint32_t idx = 0; idx < count; ++idx) {
+            Cell* cell = &this->buffer[(index + idx) & this->mask];
+            ValueType* ptr = reinterpret_cast<ValueType*>(std::addressof(cell->data));
+            std::swap(out[idx], *ptr);
+            ptr->~ValueType();
+            // Give the cell to the producer of the next round
+            cell->sequence.store(index + idx + this->mask + 1, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // Pops every value which was pushed before and calls "fn" for it in order,
+    // returns the number of popped values
+    template <typename Fn>
+    uint32_t drain(Fn fn) {
+        ValueType batch[DRAIN_BATCH_SIZE];
+        uint32_t total = 0;
+        while (true) {
+            uint32_t count = popBatch(batch, DRAIN_BATCH_SIZE);
+            for (uint32_t idx = 0; idx < count; ++idx) {
+                fn(batch[idx]);
+                batch[idx] = ValueType();
+            }
+            total += count;
+            if (count < DRAIN_BATCH_SIZE) {
+                return total;
+            }
+        }
+    }
 };
 
-#endif //_SYNCHRONIZATION_CONCURRENCY_QUEUE_H_
\ No newline at end of file
+#endif //_SYNCHRONIZATION_CONCURRENCY_QUEUE_H_
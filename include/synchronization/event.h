@@ -0,0 +1,44 @@
+#ifndef _SYNCHRONIZATION_EVENT_H_
+#define _SYNCHRONIZATION_EVENT_H_
+
+#include <atomic>
+#include <cstdint>
+
+#ifdef ESP_PLATFORM
+#include <FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <mutex>
+#include <condition_variable>
+#endif
+
+// "Event" wakes up one task which is waiting for something to do.
+// A "notify" before "wait" is not lost, the next "wait" returns at once.
+// On esp32 the waiting task sleeps on its task notification
+// (the task should not use its notification for anything else),
+// on the host it sleeps on a condition variable.
+class Event {
+private:
+    std::atomic<bool> isNotified;
+#ifdef ESP_PLATFORM
+    std::atomic<TaskHandle_t> waiter;
+#else
+    std::mutex mutex;
+    std::condition_variable condition;
+#endif
+
+public:
+    Event();
+    Event(Event&& other) = delete;
+    Event(const Event& other) = delete;
+    Event& operator=(const Event& other) = delete;
+    ~Event();
+
+    // Method can invoke on many threads
+    void notify() noexcept;
+    // Only one task waits at a time
+    // Returns true if "notify" was called, false if "timeout" (milli seconds) expired
+    bool wait(uint32_t timeout) noexcept;
+};
+
+#endif //_SYNCHRONIZATION_EVENT_H_
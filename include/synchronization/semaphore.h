@@ -0,0 +1,45 @@
+#ifndef _SYNCHRONIZATION_SEMAPHORE_H_
+#define _SYNCHRONIZATION_SEMAPHORE_H_
+
+#include <cstdint>
+
+#ifdef ESP_PLATFORM
+#include <FreeRTOS.h>
+#include <freertos/semphr.h>
+#else
+#include <mutex>
+#include <condition_variable>
+#endif
+
+// "Semaphore" wakes up one of many waiting tasks per "notify".
+// Notifications are counted up to "maxCount", so none of them is lost
+// if the tasks are busy when it is given.
+// On esp32 it is a counting semaphore of FreeRTOS,
+// on the host it is a counter guarded by a condition variable.
+class Semaphore {
+private:
+#ifdef ESP_PLATFORM
+    SemaphoreHandle_t handle;
+#else
+    std::mutex mutex;
+    std::condition_variable condition;
+    uint32_t count;
+    uint32_t maxCount;
+#endif
+
+public:
+    Semaphore(uint32_t maxCount);
+    Semaphore() = delete;
+    Semaphore(Semaphore&& other) = delete;
+    Semaphore(const Semaphore& other) = delete;
+    Semaphore& operator=(const Semaphore& other) = delete;
+    ~Semaphore();
+
+    // Method can invoke on many threads
+    void notify() noexcept;
+    // Many tasks can wait at a time
+    // Returns true if a notification was taken, false if "timeout" (milli seconds) expired
+    bool wait(uint32_t timeout) noexcept;
+};
+
+#endif //_SYNCHRONIZATION_SEMAPHORE_H_
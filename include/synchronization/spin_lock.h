@@ -1,12 +1,23 @@
 #ifndef _SYNCHRONIZATION_SPIN_LOCK_H_
 #define _SYNCHRONIZATION_SPIN_LOCK_H_
 
+#ifdef ESP_PLATFORM
 #include <FreeRTOS.h>
 #include <freertos/portmacro.h>
+#else
+#include <atomic>
+#endif
 
+// On esp32 "SpinLock" is a critical section of FreeRTOS,
+// it is safe between both cores and interrupts.
+// On the host it spins on an "std::atomic_flag"
 class SpinLock {
 private:
+#ifdef ESP_PLATFORM
     using spin_lock = portMUX_TYPE;
+#else
+    using spin_lock = std::atomic_flag;
+#endif
     spin_lock core;
 
 public:
@@ -19,4 +30,4 @@ public:
     void unlock();
 };
 
-#endif //_SYNCHRONIZATION_SPIN_LOCK_H_
\ No newline at end of file
+#endif //_SYNCHRONIZATION_SPIN_LOCK_H_
@@ -9,7 +9,7 @@
 template<typename T>
 class Array {
 public:
-    std::unique_ptr<T> buffer;
+    std::unique_ptr<T[]> buffer;
     size_t length;
 
 public:
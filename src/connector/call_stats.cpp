@@ -0,0 +1,46 @@
+#include "cso_connector/call_stats.h"
+
+CallStats::CallStats() noexcept
+    : numberPending(0),
+      numberReplied(0),
+      numberFailed(0),
+      numberTimedOut(0),
+      numberDropped(0),
+      latencyBuckets(),
+      totalLatency(0),
+      maxLatency(0) {}
+
+void CallStats::addLatency(uint64_t latency) noexcept {
+    uint64_t latencyMs = latency / 1000;
+    uint8_t bucket = 0;
+    while (latencyMs > 0 && bucket < NUMBER_LATENCY_BUCKETS - 1) {
+        latencyMs >>= 1;
+        bucket++;
+    }
+    this->latencyBuckets[bucket]++;
+    this->totalLatency += latency;
+    if (latency > this->maxLatency) {
+        this->maxLatency = latency;
+    }
+}
+
+uint64_t CallStats::getPercentile(uint8_t percent) const noexcept {
+    uint64_t total = 0;
+    for (uint8_t idx = 0; idx < NUMBER_LATENCY_BUCKETS; ++idx) {
+        total += this->latencyBuckets[idx];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (total * percent + 99) / 100;
+    uint64_t count = 0;
+    for (uint8_t idx = 0; idx < NUMBER_LATENCY_BUCKETS - 1; ++idx) {
+        count += this->latencyBuckets[idx];
+        if (count >= rank) {
+            return (1ULL << idx) * 1000ULL;
+        }
+    }
+    // The last bucket has no upper bound
+    return this->maxLatency;
+}
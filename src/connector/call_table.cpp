@@ -0,0 +1,251 @@
+#include <new>
+#include <cstring>
+#include "synchronization/clock.h"
+#include "cso_connector/call_table.h"
+
+#define DEFAULT_CAPACITY 16
+#define MAX_CAPACITY 65536
+
+std::unique_ptr<CallTable> CallTable::build() {
+    return CallTable::build(DEFAULT_CAPACITY);
+}
+
+std::unique_ptr<CallTable> CallTable::build(uint32_t capacity) {
+    return std::unique_ptr<CallTable>(new CallTable(capacity));
+}
+
+CallTable::CallTable(uint32_t capacity)
+    : capacity(capacity),
+      entries(nullptr),
+      spin(),
+      freeIndexes(nullptr),
+      numberFreeIndexes(0),
+      timers(nullptr),
+      numberTimers(0),
+      generation(1),
+      stats() {
+    if (this->capacity == 0 || this->capacity > MAX_CAPACITY) {
+        throw "[cso_connector/CallTable(uint32_t capacity)]Capacity has to be from 1 to 65536";
+    }
+    this->entries = new (std::nothrow) Entry[this->capacity];
+    this->freeIndexes = new (std::nothrow) uint32_t[this->capacity];
+    this->timers = new (std::nothrow) uint32_t[this->capacity];
+    if (this->entries == nullptr || this->freeIndexes == nullptr || this->timers == nullptr) {
+        delete[] this->entries;
+        delete[] this->freeIndexes;
+        delete[] this->timers;
+        throw "[cso_connector/CallTable(uint32_t capacity)]Not enough memory to create arrays";
+    }
+    // Lower indexes are taken first
+    for (uint32_t idx = 0; idx < this->capacity; ++idx) {
+        this->entries[idx].callID = 0;
+        this->freeIndexes[idx] = this->capacity - 1 - idx;
+    }
+    this->numberFreeIndexes = this->capacity;
+}
+
+CallTable::~CallTable() noexcept {
+    // Calls which are still pending are dropped without their callbacks
+    delete[] this->entries;
+    delete[] this->freeIndexes;
+    delete[] this->timers;
+}
+
+Result<uint32_t> CallTable::open(const char* peer, uint32_t timeout, CallCallback onComplete, void* context) noexcept {
+    if (strlen(peer) > MAX_CONNECTION_NAME_LENGTH) {
+        return Result<uint32_t>(Error::Message_InvalidConnectionName, 0);
+    }
+    uint64_t now = TIMESTAMP_MICRO_SECS();
+
+    this->spin.lock();
+    if (this->numberFreeIndexes == 0) {
+        this->spin.unlock();
+        return Result<uint32_t>(Error::CSOConnector_CallTableFull, 0);
+    }
+    uint32_t idx = this->freeIndexes[--this->numberFreeIndexes];
+    // A call ID modulo "capacity" is the index of its entry, the ID is never 0
+    if (this->generation >= UINT32_MAX / this->capacity) {
+        this->generation = 1;
+    }
+    uint32_t callID = this->generation++ * this->capacity + idx;
+
+    Entry& entry = this->entries[idx];
+    entry.callID = callID;
+    strcpy(entry.peer, peer);
+    entry.startTime = now;
+    entry.deadline = now + timeout * 1000ULL;
+    entry.onComplete = onComplete;
+    entry.context = context;
+    pushTimer(idx);
+    this->stats.numberPending++;
+    this->spin.unlock();
+    return Result<uint32_t>(Error::Nil, callID);
+}
+
+bool CallTable::complete(const char* peer, uint32_t callID, CallStatus::Code status, uint8_t* response, uint16_t lenResponse) noexcept {
+    uint64_t now = TIMESTAMP_MICRO_SECS();
+
+    this->spin.lock();
+    Entry* entry = findEntry(peer, callID);
+    if (entry == nullptr) {
+        this->spin.unlock();
+        return false;
+    }
+    CallCallback onComplete = entry->onComplete;
+    void* context = entry->context;
+    this->stats.addLatency(now - entry->startTime);
+    if (status == CallStatus::Replied) {
+        this->stats.numberReplied++;
+    } else {
+        this->stats.numberFailed++;
+    }
+    removeEntry(entry);
+    this->spin.unlock();
+
+    // The entry may be reused by "open" from now, the callback gets copies
+    if (onComplete != nullptr) {
+        onComplete(callID, status, status == CallStatus::Replied ? response : nullptr, status == CallStatus::Replied ? lenResponse : 0, context);
+    }
+    return true;
+}
+
+void CallTable::cancel(uint32_t callID) noexcept {
+    this->spin.lock();
+    Entry* entry = findEntry(nullptr, callID);
+    if (entry == nullptr) {
+        this->spin.unlock();
+        return;
+    }
+    CallCallback onComplete = entry->onComplete;
+    void* context = entry->context;
+    this->stats.numberDropped++;
+    removeEntry(entry);
+    this->spin.unlock();
+
+    if (onComplete != nullptr) {
+        onComplete(callID, CallStatus::Dropped, nullptr, 0, context);
+    }
+}
+
+void CallTable::expire(uint64_t now) noexcept {
+    while (true) {
+        this->spin.lock();
+        if (this->numberTimers == 0 || this->entries[this->timers[0]].deadline > now) {
+            this->spin.unlock();
+            return;
+        }
+        Entry* entry = &this->entries[this->timers[0]];
+        uint32_t callID = entry->callID;
+        CallCallback onComplete = entry->onComplete;
+        void* context = entry->context;
+        this->stats.numberTimedOut++;
+        removeEntry(entry);
+        this->spin.unlock();
+
+        if (onComplete != nullptr) {
+            onComplete(callID, CallStatus::TimedOut, nullptr, 0, context);
+        }
+    }
+}
+
+uint64_t CallTable::nextDeadline() noexcept {
+    this->spin.lock();
+    uint64_t deadline = UINT64_MAX;
+    if (this->numberTimers > 0) {
+        deadline = this->entries[this->timers[0]].deadline;
+    }
+    this->spin.unlock();
+    return deadline;
+}
+
+CallStats CallTable::getStats() noexcept {
+    this->spin.lock();
+    CallStats stats = this->stats;
+    this->spin.unlock();
+    return stats;
+}
+
+//========
+// PRIVATE
+//========
+// "peer" is not checked if it is nullptr
+CallTable::Entry* CallTable::findEntry(const char* peer, uint32_t callID) noexcept {
+    if (callID == 0) {
+        return nullptr;
+    }
+    Entry* entry = &this->entries[callID % this->capacity];
+    if (entry->callID != callID) {
+        return nullptr;
+    }
+    if (peer != nullptr && strcmp(entry->peer, peer) != 0) {
+        return nullptr;
+    }
+    return entry;
+}
+
+void CallTable::removeEntry(Entry* entry) noexcept {
+    removeTimer(entry->timerIndex);
+    entry->callID = 0;
+    entry->onComplete = nullptr;
+    entry->context = nullptr;
+    this->freeIndexes[this->numberFreeIndexes++] = entry - this->entries;
+    this->stats.numberPending--;
+}
+
+void CallTable::pushTimer(uint32_t idx) noexcept {
+    uint32_t position = this->numberTimers++;
+    this->timers[position] = idx;
+    this->entries[idx].timerIndex = position;
+    siftUp(position);
+}
+
+void CallTable::removeTimer(uint32_t position) noexcept {
+    uint32_t last = --this->numberTimers;
+    if (position == last) {
+        return;
+    }
+    swapTimers(position, last);
+    // The moved timer can be earlier or later than the removed one
+    siftUp(position);
+    siftDown(position);
+}
+
+void CallTable::siftUp(uint32_t position) noexcept {
+    while (position > 0) {
+        uint32_t parent = (position - 1) / 2;
+        if (this->entries[this->timers[parent]].deadline <= this->entries[this->timers[position]].deadline) {
+            return;
+        }
+        swapTimers(position, parent);
+        position = parent;
+    }
+}
+
+void CallTable::siftDown(uint32_t position) noexcept {
+    while (true) {
+        uint32_t earliest = position;
+        uint32_t left = 2 * position + 1;
+        uint32_t right = left + 1;
+        if (left < this->numberTimers &&
+            this->entries[this->timers[left]].deadline < this->entries[this->timers[earliest]].deadline) {
+            earliest = left;
+        }
+        if (right < this->numberTimers &&
+            this->entries[this->timers[right]].deadline < this->entries[this->timers[earliest]].deadline) {
+            earliest = right;
+        }
+        if (earliest == position) {
+            return;
+        }
+        swapTimers(position, earliest);
+        position = earliest;
+    }
+}
+
+void CallTable::swapTimers(uint32_t position, uint32_t other) noexcept {
+    uint32_t idx = this->timers[position];
+    this->timers[position] = this->timers[other];
+    this->timers[other] = idx;
+    this->entries[this->timers[position]].timerIndex = position;
+    this->entries[this->timers[other]].timerIndex = other;
+}
@@ -1,5 +1,4 @@
 #include <esp_log.h>
-#include <esp_timer.h>
 #include "cso_queue/queue.h"
 #include "cso_proxy/proxy.h"
 #include "cso_parser/parser.h"
@@ -7,189 +6,873 @@
 #include "cso_connector/connector.h"
 #include "cso_connection/connection.h"
 #include "message/readyticket.h"
+#include "synchronization/clock.h"
 
-#define DELAY_TIME 3000
-#define TIMESTAMP_SECS() esp_timer_get_time() / 1000000ULL
-#define TIMESTAMP_MICRO_SECS() esp_timer_get_time()
+#ifdef ESP_PLATFORM
+#include <esp_system.h>
+#else
+#include <random>
+#endif
+
+// The link is checked at least this often (milli seconds) if nothing else is due
+#define LINK_CHECK_INTERVAL 1000
+// Maximum received messages which "listen" handles in one call
+#define LISTEN_BATCH_SIZE 8
+// Maximum fragments of a large message which are in the queue at a time
+#define MAX_PENDING_FRAGMENTS 8
+// Retries of a response of "call", its deadline is the timeout of the request
+#define CALL_RESPONSE_RETRY 3
 
 // inits a new instance of Connector interface with default values
 std::unique_ptr<IConnector> Connector::build(int32_t bufferSize, std::shared_ptr<IConfig> config) {
-    auto queue = Queue::build(bufferSize);
-    auto parser = Parser::build();
-    auto proxy = Proxy::build(config);
-    return std::unique_ptr<IConnector>(new Connector(bufferSize, queue, parser, proxy,config));
+    return Connector::build(bufferSize, ConnectorOptions(), config);
+}
+
+// inits a new instance of Connector interface with "options" (see "ConnectorOptions")
+std::unique_ptr<IConnector> Connector::build(int32_t bufferSize, ConnectorOptions options, std::shared_ptr<IConfig> config) {
+    if (options.queue == nullptr) {
+        options.queue = Connector::buildQueue(bufferSize, options.sendWindow);
+    }
+    if (options.parser == nullptr) {
+        options.parser = Parser::build();
+    }
+    if (options.proxy == nullptr) {
+        options.proxy = Proxy::build(config);
+    }
+    if (options.senderCounter == nullptr) {
+        options.senderCounter = SenderCounter::build();
+    }
+    if (options.reassembler == nullptr) {
+        options.reassembler = Reassembler::build();
+    }
+    if (options.calls == nullptr) {
+        options.calls = CallTable::build();
+    }
+    if (options.subscriptions == nullptr) {
+        options.subscriptions = SubscriptionTable::build();
+    }
+    if (options.pacer == nullptr) {
+        options.pacer = Pacer::build(options.rateLimit);
+    }
+    auto conn = options.poller != nullptr ? Connection::build(bufferSize, options.poller) : Connection::build(bufferSize);
+    return std::unique_ptr<IConnector>(new Connector(options.sendWindow, conn, options.queue, options.parser, options.proxy, options.senderCounter, options.reassembler, options.calls, options.subscriptions, options.pacer, options.dispatcher, config));
 }
 
-// inits a new instance of Connector interface
-std::unique_ptr<IConnector> Connector::build(int32_t bufferSize, std::unique_ptr<IQueue> queue, std::unique_ptr<IParser> parser, std::unique_ptr<IProxy> proxy, std::shared_ptr<IConfig> config) {
-    return std::unique_ptr<IConnector>(new Connector(bufferSize, queue, parser, proxy, config));
+std::unique_ptr<IQueue> Connector::buildQueue(int32_t bufferSize, const SendWindow& sendWindow) {
+    if (!sendWindow.isCongestionControlled) {
+        return Queue::build(bufferSize, sendWindow.maxInFlight);
+    }
+    return Queue::build(bufferSize, CongestionWindow::build(sendWindow.maxInFlight));
 }
 
 Connector::Connector(
-    int32_t bufferSize, 
+    const SendWindow& sendWindow,
+    std::unique_ptr<IConnection>& conn,
     std::unique_ptr<IQueue>& queue,
     std::unique_ptr<IParser>& parser,
     std::unique_ptr<IProxy>& proxy,
+    std::unique_ptr<SenderCounter>& senderCounter,
+    std::unique_ptr<Reassembler>& reassembler,
+    std::unique_ptr<CallTable>& calls,
+    std::unique_ptr<SubscriptionTable>& subscriptions,
+    std::unique_ptr<Pacer>& pacer,
+    std::unique_ptr<Dispatcher>& dispatcher,
     std::shared_ptr<IConfig>& config
-) : time(0),
+) : runLoop(),
+    sendWindow(sendWindow),
     isActivated(false),
-    isDisconnected(true),
     serverTicket(),
     proxy(nullptr),
     parser(nullptr),
     config(config),
     counter(nullptr),
-    conn(Connection::build(bufferSize)),
-    queueMessages(nullptr) {
+    senderCounter(nullptr),
+    conn(nullptr),
+    queueMessages(nullptr),
+    dispatcher(nullptr),
+    pacer(nullptr),
+    frames(nullptr),
+    acks(nullptr),
+    numberAcks(0),
+    ackTime(0),
+    reassembler(nullptr),
+    largeMessageCallback(nullptr),
+    transferSpin(),
+    transfers(nullptr),
+    nextTransferID(0),
+    fragment(new (std::nothrow) uint8_t[sendWindow.maxFragmentSize]),
+    calls(nullptr),
+    callHandler(nullptr),
+    isCalling(false),
+    subscriptions(nullptr) {
+   // 0 is taken as 1, every ack is written at once
+   if (this->sendWindow.maxAcks == 0) {
+       this->sendWindow.maxAcks = 1;
+       this->sendWindow.ackDelay = 0;
+   }
+   this->frames.reset(new (std::nothrow) Array<uint8_t>[this->sendWindow.maxAcks + this->sendWindow.maxFrames]);
+   this->acks.reset(new (std::nothrow) PendingAck[this->sendWindow.maxAcks]);
+   if (this->frames == nullptr || this->acks == nullptr || this->fragment == nullptr) {
+       throw "[cso_connector/Connector(...)]Not enough memory to create frames";
+   }
+   this->conn.swap(conn);
    this->proxy.swap(proxy);
    this->parser.swap(parser);
    this->queueMessages.swap(queue);
+   this->senderCounter.swap(senderCounter);
+   this->reassembler.swap(reassembler);
+   this->calls.swap(calls);
+   this->subscriptions.swap(subscriptions);
+   this->dispatcher.swap(dispatcher);
+   this->pacer.swap(pacer);
+   // Receivers may still join fragments of the last boot, transfer IDs do not start at the same value
+#ifdef ESP_PLATFORM
+   this->nextTransferID.store(esp_random());
+#else
+   this->nextTransferID.store(std::random_device()());
+#endif
 }
 
-Connector::~Connector() noexcept {}
+Connector::~Connector() noexcept {
+    while (this->transfers != nullptr) {
+        OutboundTransfer* transfer = this->transfers;
+        this->transfers = transfer->next;
+        delete transfer;
+    }
+}
 
-void Connector::loopReconnect() {
-    Error::Code error;
+void Connector::run(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData)) {
     while (true) {
-        // "WiFi" will auto reconnect
-        if (WiFi.status() != WL_CONNECTED) {
-            vTaskDelay((DELAY_TIME / 3) / portTICK_PERIOD_MS);
-            continue;
+        listen(cb, LINK_CHECK_INTERVAL);
+    }
+}
+
+void Connector::listen(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData)) {
+    // Connect when it is due, otherwise read what the socket has
+    if (this->runLoop.getStage() == RunLoop::Offline) {
+        if (this->runLoop.isDue(TIMESTAMP_MICRO_SECS())) {
+            connect();
+        }
+    } else {
+        Error::Code error = this->conn->receive();
+        if (error != Error::Nil) {
+            disconnect(error);
+        }
+    }
+
+    // Receive messages, all messages of a wakeup are taken together
+    Array<uint8_t> cipher_msgs[LISTEN_BATCH_SIZE];
+    uint32_t numberMessages = this->conn->getMessages(cipher_msgs, LISTEN_BATCH_SIZE);
+    for (uint32_t idx = 0; idx < numberMessages; ++idx) {
+        handleMessage(cipher_msgs[idx], cb);
+    }
+    uint64_t now = TIMESTAMP_MICRO_SECS();
+    this->calls->expire(now);
+
+    switch (this->runLoop.getStage()) {
+        case RunLoop::Offline:
+            // Acks are built for a session, senders retry their messages on the next one
+            this->numberAcks = 0;
+            break;
+
+        case RunLoop::Activating:
+            // Do activate the connection, it is sent again if the hub does not answer
+            if (this->runLoop.isDue(now)) {
+                Error::Code error = activateConnection(
+                    this->serverTicket.ticketID,
+                    this->serverTicket.ticketBytes.get(),
+                    LENGTH_TICKET
+                );
+                if (error != Error::Nil) {
+                    log_e("%s", Error::getContent(error));
+                }
+                this->runLoop.onActivationSent(now);
+            }
+            break;
+
+        case RunLoop::Active:
+            // Send messages in queue
+            queueFragments();
+            sendQueuedMessages();
+            break;
+    }
+}
+
+void Connector::listen(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData), uint32_t timeout) {
+    uint32_t waitTime = getWaitTime(timeout);
+    if (waitTime > 0) {
+        this->conn->waitMessage(waitTime);
+    }
+    listen(cb);
+}
+
+Error::Code Connector::sendMessage(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, bool isCache) {
+    return doSendMessageNotRetry(recvName, content, lenContent, false, isEncrypted, isCache);
+}
+
+Error::Code Connector::sendGroupMessage(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, bool isCache) {
+    return doSendMessageNotRetry(groupName, content, lenContent, true, isEncrypted, isCache);
+}
+
+Error::Code Connector::sendMessageAndRetry(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, Priority::Code priority, uint32_t ttl) {
+    return doSendMessageRetry(recvName, content, lenContent, false, isEncrypted, retry, priority, ttl, nullptr, nullptr).errorCode;
+}
+
+Error::Code Connector::sendGroupMessageAndRetry(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, Priority::Code priority, uint32_t ttl) {
+    return doSendMessageRetry(groupName, content, lenContent, true, isEncrypted, retry, priority, ttl, nullptr, nullptr).errorCode;
+}
+
+Error::Code Connector::sendMessages(const OutboundMessage* messages, uint16_t numberMessages) {
+    if (!this->isActivated.load()) {
+        return Error::CSOConnector_NotActivated;
+    }
+    if (numberMessages == 0) {
+        return Error::Nil;
+    }
+
+    std::unique_ptr<Array<uint8_t>[]> data(new (std::nothrow) Array<uint8_t>[numberMessages]);
+    if (data == nullptr) {
+        return Error::NotEnoughMemory;
+    }
+    for (uint16_t idx = 0; idx < numberMessages; ++idx) {
+        const OutboundMessage& message = messages[idx];
+        Result<Array<uint8_t>> msg = buildMessageNotRetry(
+            message.recvName,
+            message.content,
+            message.lenContent,
+            message.isGroup,
+            message.isEncrypted,
+            message.isCached
+        );
+        if (msg.errorCode != Error::Nil) {
+            return msg.errorCode;
         }
+        data[idx] = std::move(msg.data);
+    }
 
-        error = prepare();
+    // Messages over the rate limit are deferred or rejected one by one, the others are written together
+    uint16_t numberFrames = 0;
+    uint16_t numberDeferred = 0;
+    Error::Code result = Error::Nil;
+    for (uint16_t idx = 0; idx < numberMessages; ++idx) {
+        bool isDeferred;
+        Error::Code error = this->pacer->admit(messages[idx].recvName, data[idx], isDeferred);
         if (error != Error::Nil) {
-            log_e("%s", Error::getContent(error));
-            vTaskDelay(DELAY_TIME / portTICK_PERIOD_MS);
+            if (result == Error::Nil) {
+                result = error;
+            }
             continue;
         }
+        if (isDeferred) {
+            numberDeferred++;
+            continue;
+        }
+        if (numberFrames != idx) {
+            data[numberFrames] = std::move(data[idx]);
+        }
+        numberFrames++;
+    }
+    if (numberDeferred > 0) {
+        this->conn->wakeUp();
+    }
+    if (numberFrames > 0) {
+        Error::Code error = this->conn->sendMessages(data.get(), numberFrames);
+        if (error != Error::Nil) {
+            return error;
+        }
+    }
+    return result;
+}
+
+Error::Code Connector::sendMessagesAndRetry(const OutboundMessage* messages, uint16_t numberMessages, int32_t retry, Priority::Code priority, uint32_t ttl) {
+    if (!this->isActivated.load()) {
+        return Error::CSOConnector_NotActivated;
+    }
+    if (numberMessages == 0) {
+        return Error::Nil;
+    }
+    // Messages which the queue would reject are found before any message is queued
+    for (uint16_t idx = 0; idx < numberMessages; ++idx) {
+        const OutboundMessage& message = messages[idx];
+        size_t lenName = message.recvName != nullptr ? strnlen(message.recvName, MAX_CONNECTION_NAME_LENGTH + 1) : 0;
+        if (lenName == 0 || lenName > MAX_CONNECTION_NAME_LENGTH) {
+            return Error::Message_InvalidConnectionName;
+        }
+        if (message.content == nullptr && message.lenContent > 0) {
+            return Error::Message_InvalidBytes;
+        }
+    }
+    if (!this->queueMessages->takeIndexes(numberMessages)) {
+        return Error::CSOConnector_MessageQueueFull;
+    }
+
+    // Every message uses one of the taken indexes, even if an earlier one failed
+    Error::Code result = Error::Nil;
+    for (uint16_t idx = 0; idx < numberMessages; ++idx) {
+        const OutboundMessage& message = messages[idx];
+        Error::Code error = this->queueMessages->pushMessage(
+            this->counter->nextWriteIndex(),
+            0,
+            message.recvName,
+            message.content,
+            message.lenContent,
+            message.isEncrypted,
+            false,
+            true,
+            true,
+            true,
+            message.isGroup,
+            priority,
+            retry + 1,
+            ttl,
+            nullptr,
+            nullptr
+        );
+        if (error != Error::Nil && result == Error::Nil) {
+            result = error;
+        }
+    }
+    // "listen" may sleep, the messages should be sent now
+    this->conn->wakeUp();
+    return result;
+}
+
+Result<uint64_t> Connector::sendLargeMessage(const char* recvName, const uint8_t* content, uint32_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority) {
+    return doSendLargeMessage(recvName, content, lenContent, false, isEncrypted, retry, onComplete, context, priority);
+}
+
+Result<uint64_t> Connector::sendGroupLargeMessage(const char* groupName, const uint8_t* content, uint32_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority) {
+    return doSendLargeMessage(groupName, content, lenContent, true, isEncrypted, retry, onComplete, context, priority);
+}
+
+void Connector::setLargeMessageCallback(Error::Code (*cb)(const char* sender, uint8_t* data, uint32_t lenData)) {
+    this->largeMessageCallback = cb;
+}
+
+Result<uint64_t> Connector::sendMessageAsync(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority, uint32_t ttl) {
+    return doSendMessageRetry(recvName, content, lenContent, false, isEncrypted, retry, priority, ttl, onComplete, context);
+}
+
+Result<uint64_t> Connector::sendGroupMessageAsync(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority, uint32_t ttl) {
+    return doSendMessageRetry(groupName, content, lenContent, true, isEncrypted, retry, priority, ttl, onComplete, context);
+}
+
+Result<uint32_t> Connector::call(const char* peer, const uint8_t* request, uint16_t lenRequest, bool isEncrypted, int32_t retry, uint32_t timeout, CallCallback onComplete, void* context, Priority::Code priority) {
+    Error::Code error = Error::Nil;
+    if (!this->isActivated.load()) {
+        error = Error::CSOConnector_NotActivated;
+    } else if (lenRequest > UINT16_MAX - CALL_HEADER_SIZE || timeout == 0) {
+        // The request expires with the call, a "ttl" of 0 would keep it forever
+        error = Error::CSOConnector_InvalidCall;
+    }
+    if (error != Error::Nil) {
+        if (onComplete != nullptr) {
+            onComplete(0, CallStatus::Dropped, nullptr, 0, context);
+        }
+        return Result<uint32_t>(error, 0);
+    }
+
+    this->isCalling.store(true);
+    // The call is opened first, its response can come before the request is sent
+    Result<uint32_t> callID = this->calls->open(peer, timeout, onComplete, context);
+    if (callID.errorCode != Error::Nil) {
+        if (onComplete != nullptr) {
+            onComplete(0, CallStatus::Dropped, nullptr, 0, context);
+        }
+        return callID;
+    }
+    error = sendCallMessage(peer, CALL_KIND_REQUEST, CallStatus::Replied, callID.data, timeout, request, lenRequest, isEncrypted, retry, priority);
+    if (error != Error::Nil) {
+        this->calls->cancel(callID.data);
+        return Result<uint32_t>(error, 0);
+    }
+    return callID;
+}
+
+void Connector::setCallHandler(Error::Code (*handler)(const char* sender, uint8_t* data, uint16_t lenData, Array<uint8_t>& response)) {
+    this->callHandler = handler;
+}
+
+CallStats Connector::getCallStats() {
+    return this->calls->getStats();
+}
+
+Result<uint32_t> Connector::subscribeGroup(const char* groupName, MessageHandler handler, void* context) {
+    return this->subscriptions->subscribe(true, groupName, handler, context);
+}
+
+Result<uint32_t> Connector::subscribeSender(const char* sender, MessageHandler handler, void* context) {
+    return this->subscriptions->subscribe(false, sender, handler, context);
+}
+
+void Connector::unsubscribe(uint32_t subscriptionID) {
+    this->subscriptions->unsubscribe(subscriptionID);
+}
+
+CongestionStats Connector::getCongestionStats() {
+    return this->queueMessages->getCongestionStats();
+}
+
+LaneStats Connector::getLaneStats(Priority::Code priority) {
+    return this->queueMessages->getLaneStats(priority);
+}
+
+uint32_t Connector::getWaitTime(uint32_t timeout) {
+    // Messages of the last wakeup are left, see "LISTEN_BATCH_SIZE"
+    if (this->conn->hasMessages()) {
+        return 0;
+    }
+    // Calls time out even if the connection is lost
+    uint64_t dueTime = this->calls->nextDeadline();
+    // The next connect or activation, nothing is sent before the connection is active
+    uint64_t nextTime = this->runLoop.getNextTime();
+    if (this->runLoop.getStage() == RunLoop::Active) {
+        nextTime = this->pacer->nextSendTime(this->queueMessages->nextDueTime());
+        if (this->numberAcks > 0) {
+            uint64_t ackDueTime = this->ackTime + this->sendWindow.ackDelay * 1000ULL;
+            if (ackDueTime < nextTime) {
+                nextTime = ackDueTime;
+            }
+        }
+    }
+    if (nextTime < dueTime) {
+        dueTime = nextTime;
+    }
+    uint64_t now = TIMESTAMP_MICRO_SECS();
+    if (dueTime <= now) {
+        return 0;
+    }
+    uint64_t waitTime = (dueTime - now + 999) / 1000;
+    return waitTime < timeout ? (uint32_t)waitTime : timeout;
+}
+
+//========
+// PRIVATE
+//========
+Error::Code Connector::prepare() {
+    auto respExchangeKey = this->proxy->exchangeKey();
+    if (respExchangeKey.errorCode != Error::Nil) {
+        return respExchangeKey.errorCode;
+    }
+    
+    auto respRegConn =  this->proxy->registerConnection(respExchangeKey.data);
+    if (respRegConn.errorCode != Error::Nil) {
+        return respRegConn.errorCode;
+    }
+    std::swap(this->serverTicket, respRegConn.data);
+    return Error::Nil;
+}
 
+void Connector::connect() {
+    // "WiFi" will auto reconnect
+    if (WiFi.status() != WL_CONNECTED) {
+        this->runLoop.onNetworkDown(TIMESTAMP_MICRO_SECS());
+        return;
+    }
+
+    Error::Code error = prepare();
+    if (error == Error::Nil) {
         // Connect to Clound Socket system
         this->parser->setSecretKey(this->serverTicket.serverSecretKey);
         error = this->conn->connect( 
             this->serverTicket.hubIP.c_str(), 
             this->serverTicket.hubPort
         );
-        if (error != Error::Nil) {
-            log_e("%s", Error::getContent(error));
-            vTaskDelay(DELAY_TIME / portTICK_PERIOD_MS);
-            continue;
-        }
+    }
+    if (error != Error::Nil) {
+        log_e("%s", Error::getContent(error));
+        this->runLoop.onConnectFailed(TIMESTAMP_MICRO_SECS());
+        return;
+    }
+    this->runLoop.onConnected(TIMESTAMP_MICRO_SECS());
+}
 
-        // Loop to receive message
-        this->isDisconnected.store(false);
-        error = this->conn->loopListen();
-        if (error != Error::Nil) {
-            log_e("%s", Error::getContent(error));
-            if (error == Error::CSOConnection_Disconnected) {
-                this->isActivated.store(false);
-                this->isDisconnected.store(true);
-            }
-        }
+void Connector::disconnect(Error::Code error) {
+    log_e("%s", Error::getContent(error));
+    this->isActivated.store(false);
+    this->pacer->clearDeferred();
+    this->runLoop.onDisconnected(TIMESTAMP_MICRO_SECS());
+}
+
+Error::Code Connector::activateConnection(uint16_t ticketID, uint8_t* ticketBytes, uint16_t lenTicket) {
+    auto msg = this->parser->buildActiveMessage(ticketID, ticketBytes, lenTicket);
+    if (msg.errorCode != Error::Nil) {
+        return msg.errorCode;
+    }    
+    return this->conn->sendMessage(msg.data.buffer.get(), msg.data.length);
+}
+
+Error::Code Connector::deliverMessage(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData), const char* sender, uint8_t* data, uint16_t lenData) {
+    if (this->dispatcher == nullptr) {
+        return cb(sender, data, lenData);
     }
+    // The message is not acknowledged if workers can not take it, the sender will retry
+    return this->dispatcher->dispatch(cb, sender, data, lenData);
 }
 
-void Connector::listen(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData)) {
-    // Receive message response
-    Array<uint8_t> cipher_msg = this->conn->getMessage();
-    if (cipher_msg.buffer != nullptr) {
-        auto msg = this->parser->parseReceivedMessage(cipher_msg.buffer.get(), cipher_msg.length);
-        if (msg.errorCode != Error::Nil) {
-            log_e("%s", Error::getContent(msg.errorCode));
+// Messages of a group or a sender with handlers are not given to "cb"
+Error::Code Connector::routeMessage(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData), bool isGroup, const char* name, uint8_t* data, uint16_t lenData) {
+    Error::Code error;
+    if (this->subscriptions->dispatch(isGroup, name, data, lenData, error)) {
+        return error;
+    }
+    return deliverMessage(cb, name, data, lenData);
+}
+
+Error::Code Connector::deliverFragment(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData), const char* sender, uint8_t* data, uint16_t lenData) {
+    uint8_t slot;
+    Error::Code error = this->reassembler->addFragment(sender, data, lenData, slot);
+    if (error == Error::CSOConnector_InvalidFragment) {
+        // It is acknowledged, retries of the fragment will never be valid
+        log_e("%s", Error::getContent(error));
+        return Error::Nil;
+    }
+    if (error != Error::Nil) {
+        return error;
+    }
+    if (!this->reassembler->isComplete(slot)) {
+        return Error::Nil;
+    }
+
+    uint8_t* content = this->reassembler->getContent(slot);
+    uint32_t lenContent = this->reassembler->getLength(slot);
+    if (this->largeMessageCallback != nullptr) {
+        error = this->largeMessageCallback(sender, content, lenContent);
+    } else if (lenContent <= UINT16_MAX) {
+        error = deliverMessage(cb, sender, content, lenContent);
+    } else {
+        log_e("[CSO_Connector]Large message is dropped, no callback for it");
+    }
+    if (error != Error::Nil) {
+        // The last fragment is not acknowledged, the message is delivered again with its retry
+        this->reassembler->revertFragment(slot, data, lenData);
+        return error;
+    }
+    this->reassembler->release(slot);
+    return Error::Nil;
+}
+
+bool Connector::isCallMessage(const uint8_t* data, uint16_t lenData) {
+    if (lenData < CALL_HEADER_SIZE || data[0] != CALL_MAGIC_0 || data[1] != CALL_MAGIC_1) {
+        return false;
+    }
+    // Calls are opt-in on both ends, messages are normal until "call" or "setCallHandler" is used
+    if (data[2] == CALL_KIND_RESPONSE) {
+        return this->isCalling.load();
+    }
+    return data[2] == CALL_KIND_REQUEST && this->callHandler != nullptr;
+}
+
+Error::Code Connector::deliverCall(const char* sender, uint8_t* data, uint16_t lenData, bool isEncrypted) {
+    uint32_t callID;
+    uint32_t timeout;
+    memcpy(&callID, data + 4, sizeof(uint32_t));
+    memcpy(&timeout, data + 8, sizeof(uint32_t));
+    uint8_t* payload = data + CALL_HEADER_SIZE;
+    uint16_t lenPayload = lenData - CALL_HEADER_SIZE;
+
+    if (data[2] == CALL_KIND_RESPONSE) {
+        // A late response is acknowledged and dropped, its call timed out
+        CallStatus::Code status = data[3] == CallStatus::Replied ? CallStatus::Replied : CallStatus::Failed;
+        this->calls->complete(sender, callID, status, payload, lenPayload);
+        return Error::Nil;
+    }
+
+    Array<uint8_t> response;
+    CallStatus::Code status = CallStatus::Replied;
+    Error::Code error = this->callHandler(sender, payload, lenPayload, response);
+    if (error == Error::Nil && response.length > UINT16_MAX - CALL_HEADER_SIZE) {
+        error = Error::CSOConnector_InvalidCall;
+    }
+    if (error != Error::Nil) {
+        log_e("%s", Error::getContent(error));
+        status = CallStatus::Failed;
+        response = Array<uint8_t>();
+    }
+
+    // The request is acknowledged even if its response can not be queued, the caller times out
+    error = sendCallMessage(sender, CALL_KIND_RESPONSE, status, callID, timeout, response.buffer.get(), response.length, isEncrypted, CALL_RESPONSE_RETRY, Priority::High);
+    if (error != Error::Nil) {
+        log_e("%s", Error::getContent(error));
+    }
+    return Error::Nil;
+}
+
+Error::Code Connector::sendCallMessage(const char* peer, uint8_t kind, CallStatus::Code status, uint32_t callID, uint32_t timeout, const uint8_t* payload, uint16_t lenPayload, bool isEncrypted, int32_t retry, Priority::Code priority) {
+    uint16_t lenMessage = lenPayload + CALL_HEADER_SIZE;
+    std::unique_ptr<uint8_t[]> message(new (std::nothrow) uint8_t[lenMessage]);
+    if (message == nullptr) {
+        return Error::NotEnoughMemory;
+    }
+    message[0] = CALL_MAGIC_0;
+    message[1] = CALL_MAGIC_1;
+    message[2] = kind;
+    message[3] = status;
+    memcpy(message.get() + 4, &callID, sizeof(uint32_t));
+    memcpy(message.get() + 8, &timeout, sizeof(uint32_t));
+    if (lenPayload > 0) {
+        memcpy(message.get() + CALL_HEADER_SIZE, payload, lenPayload);
+    }
+    // The message is useless after the timeout of the call
+    return doSendMessageRetry(peer, message.get(), lenMessage, false, isEncrypted, retry, priority, timeout, nullptr, nullptr).errorCode;
+}
+
+void Connector::handleMessage(Array<uint8_t>& cipher_msg, Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData)) {
+    auto msg = this->parser->parseReceivedMessage(cipher_msg.buffer.get(), cipher_msg.length);
+    if (msg.errorCode != Error::Nil) {
+        log_e("%s", Error::getContent(msg.errorCode));
+        return;
+    }
+
+    MessageType type = msg.data->getMsgType();
+    // Activate the connection
+    if (type == MessageType::Activation) {
+        auto readyTicket = ReadyTicket::parseBytes(msg.data->getData(), msg.data->getSizeData());
+        if (this->runLoop.getStage() != RunLoop::Activating ||
+            readyTicket.errorCode != Error::Nil || 
+            !readyTicket.data->getIsReady()) {
             return;
         }
-
-        MessageType type = msg.data->getMsgType();
-        // Activate the connection
-        if (type == MessageType::Activation) {
-            auto readyTicket = ReadyTicket::parseBytes(msg.data->getData(), msg.data->getSizeData());
-            if (readyTicket.errorCode != Error::Nil || !readyTicket.data->getIsReady()) {
-                return;
-            }
-            this->isActivated.store(true);
+        this->runLoop.onActivated();
+        this->isActivated.store(true);
+        if (this->counter == nullptr) {
+            this->counter = Counter::build(readyTicket.data->getIdxWrite());
             if (this->counter == nullptr) {
-                this->counter = Counter::build(readyTicket.data->getIdxWrite(), readyTicket.data->getIdxRead(), readyTicket.data->getMaskRead());
-                if (this->counter == nullptr) {
-                    log_e("[CSO_Connector]Not enough memory to create object");
-                }
+                log_e("[CSO_Connector]Not enough memory to create object");
             }
-            return;
         }
+        return;
+    }
 
-        if (!this->isActivated) {
-            return;
-        }
+    if (!this->isActivated) {
+        return;
+    }
 
-        if (type != MessageType::Done && 
-            type != MessageType::Single &&
-            type != MessageType::SingleCached &&
-            type != MessageType::Group &&
-            type != MessageType::GroupCached) {
-            return;
-        }
+    if (type != MessageType::Done && 
+        type != MessageType::Single &&
+        type != MessageType::SingleCached &&
+        type != MessageType::Group &&
+        type != MessageType::GroupCached) {
+        return;
+    }
+    bool isGroup = type == MessageType::Group || type == MessageType::GroupCached;
 
-        if (msg.data->getMsgID() == 0) {
-            if (msg.data->getIsRequest()) {
-                cb(msg.data->getName(), msg.data->getData(), msg.data->getSizeData());
-            }
-            return;
+    if (msg.data->getMsgID() == 0) {
+        if (msg.data->getIsRequest()) {
+            routeMessage(cb, isGroup, msg.data->getName(), msg.data->getData(), msg.data->getSizeData());
         }
+        return;
+    }
+
+    if (!msg.data->getIsRequest()) { //response
+        this->queueMessages->clearMessage(msg.data->getMsgID());
+        return;
+    }
 
-        if (!msg.data->getIsRequest()) { //response
-            this->queueMessages->clearMessage(msg.data->getMsgID());
+    // Tags of every sender are counted separately
+    if (this->senderCounter->markReadDone(msg.data->getName(), msg.data->getMsgTag())) {
+        Error::Code error;
+        // A message which is not first or not last is a fragment of a large message
+        if (!msg.data->getIsFirst() || !msg.data->getIsLast()) {
+            error = deliverFragment(cb, msg.data->getName(), msg.data->getData(), msg.data->getSizeData());
+        } else if (!isGroup && isCallMessage(msg.data->getData(), msg.data->getSizeData())) {
+            error = deliverCall(msg.data->getName(), msg.data->getData(), msg.data->getSizeData(), msg.data->getIsEncrypted());
+        } else {
+            error = routeMessage(cb, isGroup, msg.data->getName(), msg.data->getData(), msg.data->getSizeData());
+        }
+        if (error != Error::Nil) {
+            this->senderCounter->markReadUnused(msg.data->getName(), msg.data->getMsgTag());
             return;
         }
+    }
+    
+    queueAck(msg.data->getMsgID(), msg.data->getMsgTag(), msg.data->getName(), msg.data->getIsEncrypted());
+}
 
-        if (this->counter->markReadDone(msg.data->getMsgTag())) {
-            if (cb(msg.data->getName(), msg.data->getData(), msg.data->getSizeData()) != Error::Nil) {
-                this->counter->markReadUnused(msg.data->getMsgTag());
-                return;
-            }
-        }
-        
-        auto new_msg = this->parser->buildMessage(
-            msg.data->getMsgID(), 
-            msg.data->getMsgTag(),
-            msg.data->getName(),
+void Connector::queueAck(uint64_t msgID, uint64_t msgTag, const char* name, bool isEncrypted) {
+    if (this->numberAcks == 0) {
+        this->ackTime = TIMESTAMP_MICRO_SECS();
+    }
+    PendingAck& ack = this->acks[this->numberAcks++];
+    ack.msgID = msgID;
+    ack.msgTag = msgTag;
+    strncpy(ack.name, name, MAX_CONNECTION_NAME_LENGTH);
+    ack.name[MAX_CONNECTION_NAME_LENGTH] = '\0';
+    ack.isEncrypted = isEncrypted;
+    if (this->numberAcks == this->sendWindow.maxAcks) {
+        flushAcks();
+    }
+}
+
+// Builds a "Done" frame for every waiting ack, the protocol has one message ID per frame
+uint16_t Connector::buildAcks(Array<uint8_t>* frames) {
+    uint16_t numberFrames = 0;
+    for (uint16_t idx = 0; idx < this->numberAcks; ++idx) {
+        const PendingAck& ack = this->acks[idx];
+        auto msg = this->parser->buildMessage(
+            ack.msgID,
+            ack.msgTag,
+            ack.name,
             nullptr,
             0,
-            msg.data->getIsEncrypted(), 
-            false, 
-            true, 
-            true, 
+            ack.isEncrypted,
+            false,
+            true,
+            true,
             false
         );
-        if (new_msg.errorCode != Error::Nil) {
+        if (msg.errorCode != Error::Nil) {
             log_e("%s", Error::getContent(msg.errorCode));
-            return;
+            continue;
         }
-        this->conn->sendMessage(new_msg.data.buffer.get(), new_msg.data.length);
+        frames[numberFrames++] = std::move(msg.data);
     }
+    this->numberAcks = 0;
+    return numberFrames;
+}
 
-    if (this->isDisconnected.load()) {
+void Connector::flushAcks() {
+    uint16_t numberFrames = buildAcks(this->frames.get());
+    if (numberFrames == 0) {
         return;
     }
+    this->conn->sendMessages(this->frames.get(), numberFrames);
+    for (uint16_t idx = 0; idx < numberFrames; ++idx) {
+        this->frames[idx] = Array<uint8_t>();
+    }
+}
 
-    // Do activate the connection
-    if (!this->isActivated.load() && (TIMESTAMP_SECS() - this->time) >= 3) {
-        Error::Code error = activateConnection(
-            this->serverTicket.ticketID,
-            this->serverTicket.ticketBytes.get(),
-            LENGTH_TICKET
-        );
-        if (error != Error::Nil) {
-            log_e("%s", Error::getContent(error));
+void Connector::queueFragments() {
+    this->transferSpin.lock();
+    OutboundTransfer* transfer = this->transfers;
+    this->transferSpin.unlock();
+
+    // Only "listen" removes transfers, the list after "transfer" does not change
+    uint16_t lenFragment = this->sendWindow.maxFragmentSize - FRAGMENT_HEADER_SIZE;
+    uint8_t* header = this->fragment.get();
+    bool isQueueFull = false;
+    while (transfer != nullptr) {
+        OutboundTransfer* next = transfer->next;
+        while (!isQueueFull &&
+               transfer->status == SendStatus::Acked &&
+               transfer->offset < transfer->lenContent &&
+               transfer->numberPending < MAX_PENDING_FRAGMENTS) {
+            if (!this->queueMessages->takeIndex()) {
+                isQueueFull = true;
+                break;
+            }
+            uint32_t lenPart = transfer->lenContent - transfer->offset;
+            if (lenPart > lenFragment) {
+                lenPart = lenFragment;
+            }
+            memcpy(header, &transfer->transferID, sizeof(uint32_t));
+            memcpy(header + 4, &transfer->lenContent, sizeof(uint32_t));
+            memcpy(header + 8, &transfer->offset, sizeof(uint32_t));
+            memcpy(header + FRAGMENT_HEADER_SIZE, transfer->content + transfer->offset, lenPart);
+            // A message which is first and last is not a fragment, a single fragment is only first
+            bool isFirst = transfer->offset == 0;
+            bool isLast = !isFirst && transfer->offset + lenPart == transfer->lenContent;
+
+            Error::Code error = this->queueMessages->pushMessage(
+                this->counter->nextWriteIndex(),
+                0,
+                transfer->recvName,
+                header,
+                lenPart + FRAGMENT_HEADER_SIZE,
+                transfer->isEncrypted,
+                false,
+                isFirst,
+                isLast,
+                true,
+                transfer->isGroup,
+                transfer->priority,
+                transfer->retry + 1,
+                0,
+                Connector::completeFragment,
+                transfer
+            );
+            if (error != Error::Nil) {
+                transfer->status = SendStatus::Dropped;
+                break;
+            }
+            transfer->numberPending++;
+            transfer->offset += lenPart;
         }
-        this->time = TIMESTAMP_SECS();
-        return;
+
+        if (transfer->isDone()) {
+            this->transferSpin.lock();
+            OutboundTransfer** link = &this->transfers;
+            while (*link != transfer) {
+                link = &(*link)->next;
+            }
+            *link = transfer->next;
+            this->transferSpin.unlock();
+
+            if (transfer->onComplete != nullptr) {
+                transfer->onComplete(transfer->transferID, transfer->status, transfer->context);
+            }
+            delete transfer;
+        }
+        transfer = next;
+    }
+}
+
+void Connector::completeFragment(uint64_t, SendStatus::Code status, void* context) {
+    OutboundTransfer* transfer = static_cast<OutboundTransfer*>(context);
+    transfer->numberPending--;
+    if (status != SendStatus::Acked && transfer->status == SendStatus::Acked) {
+        transfer->status = status;
+    }
+}
+
+Result<uint64_t> Connector::doSendLargeMessage(const char* name, const uint8_t* content, uint32_t lenContent, bool isGroup, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority) {
+    if (!this->isActivated.load()) {
+        return Result<uint64_t>(Error::CSOConnector_NotActivated, 0);
+    }
+    if (strlen(name) > MAX_CONNECTION_NAME_LENGTH) {
+        return Result<uint64_t>(Error::Message_InvalidConnectionName, 0);
     }
+    if (lenContent == 0 || this->sendWindow.maxFragmentSize <= FRAGMENT_HEADER_SIZE) {
+        return Result<uint64_t>(Error::CSOConnector_InvalidFragment, 0);
+    }
+
+    OutboundTransfer* transfer = new (std::nothrow) OutboundTransfer();
+    if (transfer == nullptr) {
+        return Result<uint64_t>(Error::NotEnoughMemory, 0);
+    }
+    uint32_t transferID = this->nextTransferID.fetch_add(1);
+    transfer->transferID = transferID;
+    strcpy(transfer->recvName, name);
+    transfer->content = content;
+    transfer->lenContent = lenContent;
+    transfer->isGroup = isGroup;
+    transfer->isEncrypted = isEncrypted;
+    transfer->retry = retry;
+    transfer->priority = priority;
+    transfer->onComplete = onComplete;
+    transfer->context = context;
+
+    this->transferSpin.lock();
+    transfer->next = this->transfers;
+    this->transfers = transfer;
+    this->transferSpin.unlock();
+
+    // "listen" may sleep, the fragments should be queued now
+    this->conn->wakeUp();
+    return Result<uint64_t>(Error::Nil, transferID);
+}
 
-    // Send message in queue
-    if (this->isActivated.load() && (TIMESTAMP_MICRO_SECS() - this->time) >= 100) {
+// Sends due messages in queue until the send window is used up
+void Connector::sendQueuedMessages() {
+    // Deferred messages were sent earlier than queued messages, they go first
+    uint32_t bytes;
+    uint16_t numberFrames = this->pacer->takeDeferred(this->frames.get(), this->sendWindow.maxFrames, bytes);
+    while (numberFrames < this->sendWindow.maxFrames &&
+           bytes < this->sendWindow.maxBytes &&
+           this->pacer->isLinkReady()) {
         ItemQueueRef ref_msg = this->queueMessages->nextMessage();
         if (ref_msg.empty()) {
-            this->time = TIMESTAMP_MICRO_SECS();
-            return;
+            break;
         }
 
         ItemQueue& msg = ref_msg.get();
@@ -198,9 +881,9 @@ void Connector::listen(Error::Code (*cb)(const char* sender, uint8_t* data, uint
             content = this->parser->buildGroupMessage(
                 msg.msgID,
                 msg.msgTag,
-                msg.recvName.c_str(),
-                msg.content.buffer.get(),
-                msg.content.length,
+                msg.recvName,
+                msg.content,
+                msg.lenContent,
                 msg.isEncrypted,
                 msg.isCached,
                 msg.isFirst,
@@ -211,9 +894,9 @@ void Connector::listen(Error::Code (*cb)(const char* sender, uint8_t* data, uint
             content = this->parser->buildMessage(
                 msg.msgID,
                 msg.msgTag,
-                msg.recvName.c_str(),
-                msg.content.buffer.get(),
-                msg.content.length,
+                msg.recvName,
+                msg.content,
+                msg.lenContent,
                 msg.isEncrypted,
                 msg.isCached,
                 msg.isFirst,
@@ -222,75 +905,33 @@ void Connector::listen(Error::Code (*cb)(const char* sender, uint8_t* data, uint
             );
         }
         if (content.errorCode != Error::Nil) {
-            this->time = TIMESTAMP_MICRO_SECS();
-            return;
+            continue;
         }
-        this->conn->sendMessage(content.data.buffer.get(), content.data.length);
-        this->time = TIMESTAMP_MICRO_SECS();
+        bytes += content.data.length;
+        this->pacer->consumeLink(content.data.length);
+        this->frames[numberFrames++] = std::move(content.data);
     }
-}
 
-Error::Code Connector::sendMessage(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, bool isCache) {
-    return doSendMessageNotRetry(recvName, content, lenContent, false, isEncrypted, isCache);
-}
-
-Error::Code Connector::sendGroupMessage(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, bool isCache) {
-    return doSendMessageNotRetry(groupName, content, lenContent, true, isEncrypted, isCache);
-}
-
-Error::Code Connector::sendMessageAndRetry(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry) {
-    return doSendMessageRetry(recvName, content, lenContent, false, isEncrypted, retry);
-}
-
-Error::Code Connector::sendGroupMessageAndRetry(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry) {
-    return doSendMessageRetry(groupName, content, lenContent, true, isEncrypted, retry);
-}
-
-//========
-// PRIVATE
-//========
-Error::Code Connector::prepare() {
-    auto respExchangeKey = this->proxy->exchangeKey();
-    if (respExchangeKey.errorCode != Error::Nil) {
-        return respExchangeKey.errorCode;
+    // Waiting acks go with any write, otherwise they wait until they are due.
+    // They are not paced and not counted in the window
+    if (this->numberAcks > 0 &&
+        (numberFrames > 0 || TIMESTAMP_MICRO_SECS() - this->ackTime >= this->sendWindow.ackDelay * 1000ULL)) {
+        numberFrames += buildAcks(this->frames.get() + numberFrames);
     }
-    
-    auto respRegConn =  this->proxy->registerConnection(respExchangeKey.data);
-    if (respRegConn.errorCode != Error::Nil) {
-        return respRegConn.errorCode;
+    if (numberFrames == 0) {
+        return;
     }
-    std::swap(this->serverTicket, respRegConn.data);
-    return Error::Nil;
-}
 
-Error::Code Connector::activateConnection(uint16_t ticketID, uint8_t* ticketBytes, uint16_t lenTicket) {
-    auto msg = this->parser->buildActiveMessage(ticketID, ticketBytes, lenTicket);
-    if (msg.errorCode != Error::Nil) {
-        return msg.errorCode;
-    }    
-    return this->conn->sendMessage(msg.data.buffer.get(), msg.data.length);
+    // Frames are written together, the queue sends them again if the write fails
+    this->conn->sendMessages(this->frames.get(), numberFrames);
+    for (uint16_t idx = 0; idx < numberFrames; ++idx) {
+        this->frames[idx] = Array<uint8_t>();
+    }
 }
 
-Error::Code Connector::doSendMessageNotRetry(const char* name, uint8_t* content, uint16_t lenContent, bool isGroup, bool isEncrypted, bool isCache) {
-    if (!this->isActivated.load()) {
-        return Error::CSOConnector_NotActivated;
-    }
-    Result<Array<uint8_t>> data;
+Result<Array<uint8_t>> Connector::buildMessageNotRetry(const char* name, uint8_t* content, uint16_t lenContent, bool isGroup, bool isEncrypted, bool isCache) {
     if (!isGroup) {
-        data = this->parser->buildMessage(
-            0, 
-            0, 
-            name, 
-            content, 
-            lenContent, 
-            isEncrypted, 
-            isCache, 
-            true, 
-            true, 
-            true
-        );
-    } else {
-        data = this->parser->buildGroupMessage(
+        return this->parser->buildMessage(
             0, 
             0, 
             name, 
@@ -303,23 +944,60 @@ Error::Code Connector::doSendMessageNotRetry(const char* name, uint8_t* content,
             true
         );
     }
+    return this->parser->buildGroupMessage(
+        0, 
+        0, 
+        name, 
+        content, 
+        lenContent, 
+        isEncrypted, 
+        isCache, 
+        true, 
+        true, 
+        true
+    );
+}
+
+Error::Code Connector::doSendMessageNotRetry(const char* name, uint8_t* content, uint16_t lenContent, bool isGroup, bool isEncrypted, bool isCache) {
+    if (!this->isActivated.load()) {
+        return Error::CSOConnector_NotActivated;
+    }
+    Result<Array<uint8_t>> data = buildMessageNotRetry(name, content, lenContent, isGroup, isEncrypted, isCache);
     if (data.errorCode != Error::Nil) {
         return data.errorCode;
     }
+
+    bool isDeferred;
+    Error::Code error = this->pacer->admit(name, data.data, isDeferred);
+    if (error != Error::Nil) {
+        return error;
+    }
+    if (isDeferred) {
+        // "listen" may sleep, it should know when the message can be sent
+        this->conn->wakeUp();
+        return Error::Nil;
+    }
     return this->conn->sendMessage(data.data.buffer.get(), data.data.length);
 }
 
-Error::Code Connector::doSendMessageRetry(const char* name, uint8_t* content, uint16_t lenContent, bool isGroup, bool isEncrypted, int32_t retry) {
+Result<uint64_t> Connector::doSendMessageRetry(const char* name, uint8_t* content, uint16_t lenContent, bool isGroup, bool isEncrypted, int32_t retry, Priority::Code priority, uint32_t ttl, SendCallback onComplete, void* context) {
     if (!this->isActivated.load()) {
-		return Error::CSOConnector_NotActivated;
-	}
+        if (onComplete != nullptr) {
+            onComplete(0, SendStatus::Dropped, context);
+        }
+        return Result<uint64_t>(Error::CSOConnector_NotActivated, 0);
+    }
 
-	if (!this->queueMessages->takeIndex()) {
-		return Error::CSOConnector_MessageQueueFull;
-	}
+    if (!this->queueMessages->takeIndex()) {
+        if (onComplete != nullptr) {
+            onComplete(0, SendStatus::QueueFull, context);
+        }
+        return Result<uint64_t>(Error::CSOConnector_MessageQueueFull, 0);
+    }
 
-	this->queueMessages->pushMessage(new ItemQueue(
-        this->counter->nextWriteIndex(),
+    uint64_t msgID = this->counter->nextWriteIndex();
+    Error::Code error = this->queueMessages->pushMessage(
+        msgID,
         0,
         name,
         content,
@@ -330,8 +1008,19 @@ Error::Code Connector::doSendMessageRetry(const char* name, uint8_t* content, ui
         true,
         true,
         isGroup,
+        priority,
         retry + 1,
-        0
-    ));
-	return Error::Nil;
+        ttl,
+        onComplete,
+        context
+    );
+    if (error != Error::Nil) {
+        if (onComplete != nullptr) {
+            onComplete(0, SendStatus::Dropped, context);
+        }
+        return Result<uint64_t>(error, 0);
+    }
+    // "listen" may sleep, the message should be sent now
+    this->conn->wakeUp();
+    return Result<uint64_t>(Error::Nil, msgID);
 }
\ No newline at end of file
@@ -0,0 +1,15 @@
+#include "cso_connector/connector_options.h"
+
+ConnectorOptions::ConnectorOptions() noexcept
+    : sendWindow(),
+      rateLimit(),
+      dispatcher(nullptr),
+      poller(nullptr),
+      queue(nullptr),
+      parser(nullptr),
+      proxy(nullptr),
+      senderCounter(nullptr),
+      reassembler(nullptr),
+      calls(nullptr),
+      subscriptions(nullptr),
+      pacer(nullptr) {}
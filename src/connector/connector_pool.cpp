@@ -0,0 +1,74 @@
+#include <new>
+#include "cso_connector/connector_pool.h"
+
+// The links are checked at least this often (milli seconds) if nothing else is due
+#define LINK_CHECK_INTERVAL 1000
+
+std::unique_ptr<ConnectorPool> ConnectorPool::build(uint16_t maxConnectors) {
+    return std::unique_ptr<ConnectorPool>(new ConnectorPool(maxConnectors));
+}
+
+ConnectorPool::ConnectorPool(uint16_t maxConnectors)
+    : poller(nullptr),
+      members(nullptr),
+      maxConnectors(maxConnectors),
+      numberConnectors(0) {
+    if (this->maxConnectors == 0) {
+        throw "[cso_connector/ConnectorPool(uint16_t maxConnectors)]Connectors have to be larger than 0";
+    }
+    this->members.reset(new (std::nothrow) Member[this->maxConnectors]);
+    if (this->members == nullptr) {
+        throw "[cso_connector/ConnectorPool(uint16_t maxConnectors)]Not enough memory to create array";
+    }
+    this->poller = Poller::build(this->maxConnectors);
+}
+
+ConnectorPool::~ConnectorPool() noexcept {}
+
+std::shared_ptr<Poller> ConnectorPool::getPoller() noexcept {
+    return this->poller;
+}
+
+Result<uint16_t> ConnectorPool::add(std::unique_ptr<IConnector> connector, Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData)) {
+    if (this->numberConnectors == this->maxConnectors) {
+        return Result<uint16_t>(Error::CSOConnector_PoolFull, 0);
+    }
+    Member& member = this->members[this->numberConnectors];
+    member.connector.swap(connector);
+    member.cb = cb;
+    return Result<uint16_t>(Error::Nil, this->numberConnectors++);
+}
+
+IConnector* ConnectorPool::get(uint16_t idx) noexcept {
+    if (idx >= this->numberConnectors) {
+        return nullptr;
+    }
+    return this->members[idx].connector.get();
+}
+
+uint16_t ConnectorPool::getNumberConnectors() noexcept {
+    return this->numberConnectors;
+}
+
+void ConnectorPool::listen(uint32_t timeout) {
+    // The earliest connector decides how long the task sleeps
+    uint32_t waitTime = timeout;
+    for (uint16_t idx = 0; idx < this->numberConnectors && waitTime > 0; ++idx) {
+        waitTime = this->members[idx].connector->getWaitTime(waitTime);
+    }
+    if (waitTime > 0) {
+        this->poller->wait(waitTime);
+    }
+
+    // A step of a connector which has nothing to do only checks its socket
+    for (uint16_t idx = 0; idx < this->numberConnectors; ++idx) {
+        Member& member = this->members[idx];
+        member.connector->listen(member.cb);
+    }
+}
+
+void ConnectorPool::run() {
+    while (true) {
+        listen(LINK_CHECK_INTERVAL);
+    }
+}
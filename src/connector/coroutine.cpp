@@ -0,0 +1,184 @@
+#include "cso_connector/coroutine.h"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <new>
+#include <cstring>
+#include <exception>
+
+#define DEFAULT_INBOX_CAPACITY 16
+
+void Task::promise_type::unhandled_exception() noexcept {
+    std::terminate();
+}
+
+Completion::Completion() noexcept
+    : state(Started),
+      handle(nullptr) {}
+
+bool Completion::suspend(std::coroutine_handle<> handle) noexcept {
+    this->handle = handle;
+    uint8_t expected = Started;
+    return this->state.compare_exchange_strong(expected, Suspended);
+}
+
+void Completion::complete() noexcept {
+    if (this->state.exchange(Done) == Suspended) {
+        this->handle.resume();
+    }
+}
+
+SendAwaiter::SendAwaiter(IConnector& connector, const char* recvName, uint8_t* content, uint16_t lenContent, bool isGroup, bool isEncrypted, int32_t retry, Priority::Code priority, uint32_t ttl) noexcept
+    : connector(connector),
+      recvName(recvName),
+      content(content),
+      lenContent(lenContent),
+      isGroup(isGroup),
+      isEncrypted(isEncrypted),
+      retry(retry),
+      priority(priority),
+      ttl(ttl),
+      completion(),
+      result{0, SendStatus::Dropped} {}
+
+bool SendAwaiter::await_suspend(std::coroutine_handle<> handle) noexcept {
+    // "onComplete" is called at once if the message can not be queued
+    if (this->isGroup) {
+        this->connector.sendGroupMessageAsync(this->recvName, this->content, this->lenContent, this->isEncrypted, this->retry, &SendAwaiter::complete, this, this->priority, this->ttl);
+    } else {
+        this->connector.sendMessageAsync(this->recvName, this->content, this->lenContent, this->isEncrypted, this->retry, &SendAwaiter::complete, this, this->priority, this->ttl);
+    }
+    return this->completion.suspend(handle);
+}
+
+void SendAwaiter::complete(uint64_t msgID, SendStatus::Code status, void* context) {
+    SendAwaiter* awaiter = static_cast<SendAwaiter*>(context);
+    awaiter->result.msgID = msgID;
+    awaiter->result.status = status;
+    awaiter->completion.complete();
+}
+
+CallAwaiter::CallAwaiter(IConnector& connector, const char* peer, const uint8_t* request, uint16_t lenRequest, bool isEncrypted, int32_t retry, uint32_t timeout, Priority::Code priority) noexcept
+    : connector(connector),
+      peer(peer),
+      request(request),
+      lenRequest(lenRequest),
+      isEncrypted(isEncrypted),
+      retry(retry),
+      timeout(timeout),
+      priority(priority),
+      completion(),
+      result{0, CallStatus::Dropped, Array<uint8_t>()} {}
+
+bool CallAwaiter::await_suspend(std::coroutine_handle<> handle) noexcept {
+    // "onComplete" is called at once with "Dropped" if the request can not be queued
+    this->connector.call(this->peer, this->request, this->lenRequest, this->isEncrypted, this->retry, this->timeout, &CallAwaiter::complete, this, this->priority);
+    return this->completion.suspend(handle);
+}
+
+void CallAwaiter::complete(uint32_t callID, CallStatus::Code status, uint8_t* response, uint16_t lenResponse, void* context) {
+    CallAwaiter* awaiter = static_cast<CallAwaiter*>(context);
+    awaiter->result.callID = callID;
+    awaiter->result.status = status;
+    // "response" is only valid during the callback
+    if (response != nullptr && lenResponse > 0) {
+        uint8_t* copied = new (std::nothrow) uint8_t[lenResponse];
+        if (copied != nullptr) {
+            memcpy(copied, response, lenResponse);
+            awaiter->result.response = Array<uint8_t>(copied, lenResponse);
+        } else {
+            awaiter->result.status = CallStatus::Failed;
+        }
+    }
+    awaiter->completion.complete();
+}
+
+std::unique_ptr<Inbox> Inbox::build(IConnector& connector, bool isGroup, const char* name) {
+    return Inbox::build(connector, isGroup, name, DEFAULT_INBOX_CAPACITY);
+}
+
+std::unique_ptr<Inbox> Inbox::build(IConnector& connector, bool isGroup, const char* name, uint16_t capacity) {
+    return std::unique_ptr<Inbox>(new Inbox(connector, isGroup, name, capacity));
+}
+
+Inbox::Inbox(IConnector& connector, bool isGroup, const char* name, uint16_t capacity)
+    : connector(connector),
+      subscriptionID(0),
+      messages(nullptr),
+      capacity(capacity),
+      head(0),
+      numberMessages(0),
+      waiter(nullptr) {
+    if (this->capacity == 0) {
+        throw "[cso_connector/Inbox(IConnector& connector, bool isGroup, const char* name, uint16_t capacity)]Capacity has to be larger than 0";
+    }
+    this->messages.reset(new (std::nothrow) Message[this->capacity]);
+    if (this->messages == nullptr) {
+        throw "[cso_connector/Inbox(IConnector& connector, bool isGroup, const char* name, uint16_t capacity)]Not enough memory to create array";
+    }
+    Result<uint32_t> subscription = isGroup ?
+        this->connector.subscribeGroup(name, &Inbox::handle, this) :
+        this->connector.subscribeSender(name, &Inbox::handle, this);
+    if (subscription.errorCode != Error::Nil) {
+        throw "[cso_connector/Inbox(IConnector& connector, bool isGroup, const char* name, uint16_t capacity)]Can not subscribe";
+    }
+    this->subscriptionID = subscription.data;
+}
+
+Inbox::~Inbox() noexcept {
+    this->connector.unsubscribe(this->subscriptionID);
+}
+
+Inbox::ReceiveAwaiter Inbox::receive() noexcept {
+    return ReceiveAwaiter(*this);
+}
+
+//========
+// PRIVATE
+//========
+Inbox::Message Inbox::pop() noexcept {
+    Message message = std::move(this->messages[this->head]);
+    this->head = (this->head + 1) % this->capacity;
+    this->numberMessages--;
+    return message;
+}
+
+Error::Code Inbox::handle(const char* sender, uint8_t* data, uint16_t lenData, void* context) {
+    Inbox* inbox = static_cast<Inbox*>(context);
+    if (inbox->numberMessages == inbox->capacity) {
+        return Error::CSOConnector_InboxFull;
+    }
+
+    uint8_t* copied = new (std::nothrow) uint8_t[lenData > 0 ? lenData : 1];
+    if (copied == nullptr) {
+        return Error::NotEnoughMemory;
+    }
+    memcpy(copied, data, lenData);
+    Message& message = inbox->messages[(inbox->head + inbox->numberMessages) % inbox->capacity];
+    strncpy(message.sender, sender, MAX_CONNECTION_NAME_LENGTH);
+    message.sender[MAX_CONNECTION_NAME_LENGTH] = '\0';
+    message.data = Array<uint8_t>(copied, lenData);
+    inbox->numberMessages++;
+
+    // The waiting coroutine runs until its next "co_await" before the message is acknowledged
+    if (inbox->waiter) {
+        std::coroutine_handle<> waiter = inbox->waiter;
+        inbox->waiter = nullptr;
+        waiter.resume();
+    }
+    return Error::Nil;
+}
+
+SendAwaiter awaitSend(IConnector& connector, const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, Priority::Code priority, uint32_t ttl) noexcept {
+    return SendAwaiter(connector, recvName, content, lenContent, false, isEncrypted, retry, priority, ttl);
+}
+
+SendAwaiter awaitSendGroup(IConnector& connector, const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, Priority::Code priority, uint32_t ttl) noexcept {
+    return SendAwaiter(connector, groupName, content, lenContent, true, isEncrypted, retry, priority, ttl);
+}
+
+CallAwaiter awaitCall(IConnector& connector, const char* peer, const uint8_t* request, uint16_t lenRequest, bool isEncrypted, int32_t retry, uint32_t timeout, Priority::Code priority) noexcept {
+    return CallAwaiter(connector, peer, request, lenRequest, isEncrypted, retry, timeout, priority);
+}
+
+#endif
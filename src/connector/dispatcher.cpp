@@ -0,0 +1,138 @@
+#include <new>
+#include <cstring>
+#include "cso_connector/dispatcher.h"
+
+#define DISPATCH_BATCH_SIZE 8
+#define WORKER_WAIT_TIME 100 // (milli seconds)
+#define WORKER_STACK_SIZE 8 * 1024
+#define WORKER_PRIORITY 1
+
+Delivery::Delivery() noexcept 
+    : cb(nullptr),
+      content(),
+      lenData(0) {}
+
+Delivery::Delivery(Delivery&& other) noexcept
+    : cb(other.cb),
+      content(std::move(other.content)),
+      lenData(other.lenData) {}
+
+Delivery& Delivery::operator=(Delivery&& other) noexcept {
+    this->cb = other.cb;
+    this->content = std::move(other.content);
+    this->lenData = other.lenData;
+    return *this;
+}
+
+std::unique_ptr<Dispatcher> Dispatcher::build(uint32_t queueSize) {
+    return Dispatcher::build(queueSize, 1);
+}
+
+std::unique_ptr<Dispatcher> Dispatcher::build(uint32_t queueSize, uint8_t numberWorkers) {
+    return std::unique_ptr<Dispatcher>(new Dispatcher(queueSize, numberWorkers));
+}
+
+Dispatcher::Dispatcher(uint32_t queueSize, uint8_t numberWorkers)
+    : deliveries(queueSize),
+      deliverySignal(queueSize),
+      isStopped(false),
+      numberRunning(0) {
+    if (numberWorkers == 0) {
+        throw "[cso_connector/Dispatcher(uint32_t queueSize, uint8_t numberWorkers)]Number of workers has to be larger than 0";
+    }
+
+#ifdef ESP_PLATFORM
+    // The worker runs on the other core, more workers would only share that core
+    if (numberWorkers > 1) {
+        throw "[cso_connector/Dispatcher(uint32_t queueSize, uint8_t numberWorkers)]Esp32 has one worker";
+    }
+    BaseType_t core = xPortGetCoreID() == 0 ? 1 : 0;
+    this->numberRunning.store(1);
+    if (xTaskCreatePinnedToCore(
+            Dispatcher::runWorker,
+            "Dispatch-Task",
+            WORKER_STACK_SIZE,
+            this,
+            WORKER_PRIORITY,
+            nullptr,
+            core) != pdPASS) {
+        throw "[cso_connector/Dispatcher(uint32_t queueSize, uint8_t numberWorkers)]Can not create worker task";
+    }
+#else
+    for (uint8_t idx = 0; idx < numberWorkers; ++idx) {
+        this->numberRunning.fetch_add(1);
+        this->workers.emplace_back(Dispatcher::runWorker, this);
+    }
+#endif
+}
+
+Dispatcher::~Dispatcher() noexcept {
+    this->isStopped.store(true);
+#ifdef ESP_PLATFORM
+    while (this->numberRunning.load() > 0) {
+        this->deliverySignal.notify();
+        vTaskDelay(1);
+    }
+#else
+    for (size_t idx = 0; idx < this->workers.size(); ++idx) {
+        this->deliverySignal.notify();
+    }
+    for (auto& worker : this->workers) {
+        worker.join();
+    }
+#endif
+}
+
+Error::Code Dispatcher::dispatch(Error::Code (*cb)(const char* sender, uint8_t* data, uint16_t lenData), const char* sender, const uint8_t* data, uint16_t lenData) noexcept {
+    size_t lenSender = strlen(sender);
+    uint8_t* content = new (std::nothrow) uint8_t[lenSender + 1 + lenData];
+    if (content == nullptr) {
+        return Error::NotEnoughMemory;
+    }
+    memcpy(content, sender, lenSender + 1);
+    if (lenData > 0) {
+        memcpy(content + lenSender + 1, data, lenData);
+    }
+
+    Delivery delivery;
+    delivery.cb = cb;
+    delivery.content = Array<uint8_t>(content, lenSender + 1 + lenData);
+    delivery.lenData = lenData;
+    Error::Code error = this->deliveries.push(std::move(delivery));
+    if (error != Error::Nil) {
+        return error;
+    }
+    this->deliverySignal.notify();
+    return Error::Nil;
+}
+
+//========
+// PRIVATE
+//========
+void Dispatcher::runWorker(void* param) {
+    Dispatcher* dispatcher = static_cast<Dispatcher*>(param);
+    dispatcher->loopDispatch();
+    dispatcher->numberRunning.fetch_sub(1);
+#ifdef ESP_PLATFORM
+    vTaskDelete(nullptr);
+#endif
+}
+
+void Dispatcher::loopDispatch() noexcept {
+    Delivery batch[DISPATCH_BATCH_SIZE];
+    while (!this->isStopped.load()) {
+        uint32_t numberDeliveries = this->deliveries.popBatch(batch, DISPATCH_BATCH_SIZE);
+        if (numberDeliveries == 0) {
+            this->deliverySignal.wait(WORKER_WAIT_TIME);
+            continue;
+        }
+
+        for (uint32_t idx = 0; idx < numberDeliveries; ++idx) {
+            Delivery& delivery = batch[idx];
+            const char* sender = reinterpret_cast<const char*>(delivery.content.buffer.get());
+            uint8_t* data = delivery.content.buffer.get() + delivery.content.length - delivery.lenData;
+            delivery.cb(sender, data, delivery.lenData);
+            delivery.content = Array<uint8_t>();
+        }
+    }
+}
@@ -0,0 +1,17 @@
+#include "cso_connector/outbound_message.h"
+
+OutboundMessage::OutboundMessage() noexcept
+    : recvName(nullptr),
+      content(nullptr),
+      lenContent(0),
+      isGroup(false),
+      isEncrypted(false),
+      isCached(false) {}
+
+OutboundMessage::OutboundMessage(const char* recvName, uint8_t* content, uint16_t lenContent, bool isGroup, bool isEncrypted, bool isCached) noexcept
+    : recvName(recvName),
+      content(content),
+      lenContent(lenContent),
+      isGroup(isGroup),
+      isEncrypted(isEncrypted),
+      isCached(isCached) {}
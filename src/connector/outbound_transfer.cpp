@@ -0,0 +1,24 @@
+#include "cso_connector/outbound_transfer.h"
+
+OutboundTransfer::OutboundTransfer() noexcept
+    : transferID(0),
+      recvName(),
+      content(nullptr),
+      lenContent(0),
+      offset(0),
+      numberPending(0),
+      isGroup(false),
+      isEncrypted(false),
+      retry(0),
+      priority(Priority::Bulk),
+      status(SendStatus::Acked),
+      onComplete(nullptr),
+      context(nullptr),
+      next(nullptr) {}
+
+bool OutboundTransfer::isDone() noexcept {
+    if (this->numberPending > 0) {
+        return false;
+    }
+    return this->offset >= this->lenContent || this->status != SendStatus::Acked;
+}
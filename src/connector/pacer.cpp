@@ -0,0 +1,224 @@
+#include <new>
+#include <cstring>
+#include "synchronization/clock.h"
+#include "cso_connector/pacer.h"
+
+#define DEFAULT_MAX_RECIPIENTS 8
+
+std::unique_ptr<Pacer> Pacer::build() {
+    return Pacer::build(RateLimit(), DEFAULT_MAX_RECIPIENTS);
+}
+
+std::unique_ptr<Pacer> Pacer::build(const RateLimit& rateLimit) {
+    return Pacer::build(rateLimit, DEFAULT_MAX_RECIPIENTS);
+}
+
+std::unique_ptr<Pacer> Pacer::build(const RateLimit& rateLimit, uint8_t maxRecipients) {
+    return std::unique_ptr<Pacer>(new Pacer(rateLimit, maxRecipients));
+}
+
+Pacer::Pacer(const RateLimit& rateLimit, uint8_t maxRecipients)
+    : rateLimit(rateLimit),
+      isLimited(rateLimit.bytesPerSecond > 0 || rateLimit.messagesPerRecipient > 0),
+      maxRecipients(maxRecipients),
+      spin(),
+      link(),
+      recipients(nullptr),
+      numberRecipients(0),
+      deferred(nullptr),
+      headDeferred(0),
+      numberDeferred(0) {
+    if (this->maxRecipients == 0) {
+        throw "[cso_connector/Pacer(const RateLimit& rateLimit, uint8_t maxRecipients)]Recipients have to be larger than 0";
+    }
+    this->recipients = new (std::nothrow) Recipient[this->maxRecipients];
+    if (this->recipients == nullptr) {
+        throw "[cso_connector/Pacer(const RateLimit& rateLimit, uint8_t maxRecipients)]Not enough memory to create array";
+    }
+    if (this->rateLimit.maxDeferred > 0) {
+        this->deferred = new (std::nothrow) Deferred[this->rateLimit.maxDeferred];
+        if (this->deferred == nullptr) {
+            delete[] this->recipients;
+            throw "[cso_connector/Pacer(const RateLimit& rateLimit, uint8_t maxRecipients)]Not enough memory to create array";
+        }
+    }
+    this->link.reset(this->rateLimit.bytesPerSecond, this->rateLimit.burstBytes, TIMESTAMP_MICRO_SECS());
+}
+
+Pacer::~Pacer() noexcept {
+    delete[] this->recipients;
+    delete[] this->deferred;
+}
+
+Error::Code Pacer::admit(const char* recvName, Array<uint8_t>& frame, bool& isDeferred) noexcept {
+    isDeferred = false;
+    if (!this->isLimited) {
+        return Error::Nil;
+    }
+    uint64_t now = TIMESTAMP_MICRO_SECS();
+
+    this->spin.lock();
+    if (this->numberDeferred == 0) {
+        uint8_t recipient = findRecipient(recvName, now);
+        if (hasTokens(recipient, frame.length, now)) {
+            takeTokens(recipient, frame.length);
+            this->spin.unlock();
+            return Error::Nil;
+        }
+    }
+    if (this->numberDeferred == this->rateLimit.maxDeferred) {
+        this->spin.unlock();
+        return Error::CSOConnector_RateLimited;
+    }
+    Deferred& item = this->deferred[(this->headDeferred + this->numberDeferred) % this->rateLimit.maxDeferred];
+    strncpy(item.recvName, recvName, MAX_CONNECTION_NAME_LENGTH);
+    item.recvName[MAX_CONNECTION_NAME_LENGTH] = '\0';
+    item.frame = std::move(frame);
+    this->numberDeferred++;
+    this->spin.unlock();
+    isDeferred = true;
+    return Error::Nil;
+}
+
+uint16_t Pacer::takeDeferred(Array<uint8_t>* frames, uint16_t maxFrames, uint32_t& bytes) noexcept {
+    bytes = 0;
+    if (!this->isLimited) {
+        return 0;
+    }
+    uint64_t now = TIMESTAMP_MICRO_SECS();
+
+    uint16_t numberFrames = 0;
+    this->spin.lock();
+    while (this->numberDeferred > 0 && numberFrames < maxFrames) {
+        Deferred& item = this->deferred[this->headDeferred];
+        uint8_t recipient = findRecipient(item.recvName, now);
+        // The order is kept, a message waits for the messages before it
+        if (!hasTokens(recipient, item.frame.length, now)) {
+            break;
+        }
+        takeTokens(recipient, item.frame.length);
+        bytes += item.frame.length;
+        frames[numberFrames++] = std::move(item.frame);
+        item.frame = Array<uint8_t>();
+        this->headDeferred = (this->headDeferred + 1) % this->rateLimit.maxDeferred;
+        this->numberDeferred--;
+    }
+    this->spin.unlock();
+    return numberFrames;
+}
+
+bool Pacer::isLinkReady() noexcept {
+    if (this->rateLimit.bytesPerSecond == 0) {
+        return true;
+    }
+    this->spin.lock();
+    bool isReady = this->link.hasTokens(1, TIMESTAMP_MICRO_SECS());
+    this->spin.unlock();
+    return isReady;
+}
+
+void Pacer::consumeLink(uint32_t bytes) noexcept {
+    if (this->rateLimit.bytesPerSecond == 0) {
+        return;
+    }
+    this->spin.lock();
+    this->link.take(bytes);
+    this->spin.unlock();
+}
+
+uint64_t Pacer::nextSendTime(uint64_t dueTime) noexcept {
+    if (!this->isLimited) {
+        return dueTime;
+    }
+    uint64_t now = TIMESTAMP_MICRO_SECS();
+
+    this->spin.lock();
+    // Due messages of the queue wait for tokens of the connection
+    if (dueTime != UINT64_MAX && this->link.isLimited()) {
+        this->link.hasTokens(1, now);
+        uint64_t linkTime = this->link.readyTime(1);
+        if (linkTime > dueTime) {
+            dueTime = linkTime;
+        }
+    }
+    if (this->numberDeferred > 0) {
+        Deferred& item = this->deferred[this->headDeferred];
+        uint8_t recipient = findRecipient(item.recvName, now);
+        uint64_t deferredTime = this->link.readyTime(item.frame.length);
+        if (recipient < this->maxRecipients) {
+            uint64_t recipientTime = this->recipients[recipient].bucket.readyTime(1);
+            if (recipientTime > deferredTime) {
+                deferredTime = recipientTime;
+            }
+        }
+        if (deferredTime < dueTime) {
+            dueTime = deferredTime;
+        }
+    }
+    this->spin.unlock();
+    return dueTime;
+}
+
+void Pacer::clearDeferred() noexcept {
+    this->spin.lock();
+    while (this->numberDeferred > 0) {
+        this->deferred[this->headDeferred].frame = Array<uint8_t>();
+        this->headDeferred = (this->headDeferred + 1) % this->rateLimit.maxDeferred;
+        this->numberDeferred--;
+    }
+    this->spin.unlock();
+}
+
+//========
+// PRIVATE
+//========
+// FNV-1a
+uint32_t Pacer::hashName(const char* name) noexcept {
+    uint32_t hash = 2166136261U;
+    for (; *name != '\0'; ++name) {
+        hash ^= (uint8_t)*name;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+// Returns "maxRecipients" if recipients are unlimited
+uint8_t Pacer::findRecipient(const char* name, uint64_t now) noexcept {
+    if (this->rateLimit.messagesPerRecipient == 0) {
+        return this->maxRecipients;
+    }
+
+    uint32_t hash = hashName(name);
+    uint8_t oldest = 0;
+    for (uint8_t idx = 0; idx < this->numberRecipients; ++idx) {
+        Recipient& recipient = this->recipients[idx];
+        if (recipient.hash == hash && strcmp(recipient.name, name) == 0) {
+            return idx;
+        }
+        if (recipient.bucket.getUpdateTime() < this->recipients[oldest].bucket.getUpdateTime()) {
+            oldest = idx;
+        }
+    }
+
+    uint8_t idx = this->numberRecipients < this->maxRecipients ? this->numberRecipients++ : oldest;
+    Recipient& recipient = this->recipients[idx];
+    strncpy(recipient.name, name, MAX_CONNECTION_NAME_LENGTH);
+    recipient.name[MAX_CONNECTION_NAME_LENGTH] = '\0';
+    recipient.hash = hash;
+    recipient.bucket.reset(this->rateLimit.messagesPerRecipient, this->rateLimit.burstPerRecipient, now);
+    return idx;
+}
+
+bool Pacer::hasTokens(uint8_t recipient, uint32_t lenFrame, uint64_t now) noexcept {
+    if (!this->link.hasTokens(lenFrame, now)) {
+        return false;
+    }
+    return recipient == this->maxRecipients || this->recipients[recipient].bucket.hasTokens(1, now);
+}
+
+void Pacer::takeTokens(uint8_t recipient, uint32_t lenFrame) noexcept {
+    this->link.take(lenFrame);
+    if (recipient < this->maxRecipients) {
+        this->recipients[recipient].bucket.take(1);
+    }
+}
@@ -0,0 +1,24 @@
+#include "cso_connector/rate_limit.h"
+
+#define DEFAULT_MAX_DEFERRED 8
+
+RateLimit::RateLimit() noexcept
+    : bytesPerSecond(0),
+      burstBytes(0),
+      messagesPerRecipient(0),
+      burstPerRecipient(0),
+      maxDeferred(DEFAULT_MAX_DEFERRED) {}
+
+RateLimit::RateLimit(uint32_t bytesPerSecond, uint32_t burstBytes) noexcept
+    : bytesPerSecond(bytesPerSecond),
+      burstBytes(burstBytes),
+      messagesPerRecipient(0),
+      burstPerRecipient(0),
+      maxDeferred(DEFAULT_MAX_DEFERRED) {}
+
+RateLimit::RateLimit(uint32_t bytesPerSecond, uint32_t burstBytes, uint16_t messagesPerRecipient, uint16_t burstPerRecipient, uint16_t maxDeferred) noexcept
+    : bytesPerSecond(bytesPerSecond),
+      burstBytes(burstBytes),
+      messagesPerRecipient(messagesPerRecipient),
+      burstPerRecipient(burstPerRecipient),
+      maxDeferred(maxDeferred) {}
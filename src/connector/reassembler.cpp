@@ -0,0 +1,164 @@
+#include <new>
+#include <cstring>
+#include "synchronization/clock.h"
+#include "cso_connector/reassembler.h"
+
+#define DEFAULT_CAPACITY 4
+#define DEFAULT_MAX_MESSAGE_SIZE 65536
+#define DEFAULT_TIMEOUT 30000 // (milli seconds)
+#define NUMBER_BITS 32
+
+std::unique_ptr<Reassembler> Reassembler::build() {
+    return Reassembler::build(DEFAULT_CAPACITY, DEFAULT_MAX_MESSAGE_SIZE, DEFAULT_TIMEOUT);
+}
+
+std::unique_ptr<Reassembler> Reassembler::build(uint8_t capacity, uint32_t maxMessageSize, uint32_t timeout) {
+    return std::unique_ptr<Reassembler>(new Reassembler(capacity, maxMessageSize, timeout));
+}
+
+Reassembler::Reassembler(uint8_t capacity, uint32_t maxMessageSize, uint32_t timeout)
+    : capacity(capacity),
+      maxMessageSize(maxMessageSize),
+      timeout(timeout * 1000ULL),
+      entries(nullptr) {
+    if (this->capacity == 0) {
+        throw "[cso_connector/Reassembler(uint8_t capacity, uint32_t maxMessageSize, uint32_t timeout)]Capacity has to be larger than 0";
+    }
+    this->entries = new (std::nothrow) Entry[this->capacity];
+    if (this->entries == nullptr) {
+        throw "[cso_connector/Reassembler(uint8_t capacity, uint32_t maxMessageSize, uint32_t timeout)]Not enough memory to create array";
+    }
+    for (uint8_t idx = 0; idx < this->capacity; ++idx) {
+        this->entries[idx].content = nullptr;
+        this->entries[idx].receivedBits = nullptr;
+    }
+}
+
+Reassembler::~Reassembler() noexcept {
+    for (uint8_t idx = 0; idx < this->capacity; ++idx) {
+        delete[] this->entries[idx].content;
+        delete[] this->entries[idx].receivedBits;
+    }
+    delete[] this->entries;
+}
+
+Error::Code Reassembler::addFragment(const char* sender, const uint8_t* fragment, uint16_t lenFragment, uint8_t& slot) noexcept {
+    if (lenFragment <= FRAGMENT_HEADER_SIZE || strlen(sender) > MAX_CONNECTION_NAME_LENGTH) {
+        return Error::CSOConnector_InvalidFragment;
+    }
+    uint32_t transferID;
+    uint32_t lenMessage;
+    uint32_t offset;
+    memcpy(&transferID, fragment, sizeof(uint32_t));
+    memcpy(&lenMessage, fragment + 4, sizeof(uint32_t));
+    memcpy(&offset, fragment + 8, sizeof(uint32_t));
+    uint16_t lenPart = lenFragment - FRAGMENT_HEADER_SIZE;
+    if (lenMessage > this->maxMessageSize || offset > lenMessage || lenPart > lenMessage - offset) {
+        return Error::CSOConnector_InvalidFragment;
+    }
+
+    uint64_t now = TIMESTAMP_MICRO_SECS();
+    Entry* entry = findEntry(sender, transferID, lenMessage, now);
+    if (entry == nullptr) {
+        return Error::CSOConnector_ReassemblyFull;
+    }
+    if (entry->content == nullptr) {
+        uint32_t numberWords = (lenMessage + NUMBER_BITS - 1) / NUMBER_BITS;
+        entry->content = new (std::nothrow) uint8_t[lenMessage];
+        entry->receivedBits = new (std::nothrow) uint32_t[numberWords];
+        if (entry->content == nullptr || entry->receivedBits == nullptr) {
+            release(entry - this->entries);
+            return Error::NotEnoughMemory;
+        }
+        memset(entry->receivedBits, 0, numberWords * sizeof(uint32_t));
+        strcpy(entry->sender, sender);
+        entry->transferID = transferID;
+        entry->lenContent = lenMessage;
+        entry->lenReceived = 0;
+    }
+
+    memcpy(entry->content + offset, fragment + FRAGMENT_HEADER_SIZE, lenPart);
+    entry->lenReceived += markReceived(entry->receivedBits, offset, lenPart, true);
+    entry->updateTime = now;
+    slot = entry - this->entries;
+    return Error::Nil;
+}
+
+bool Reassembler::isComplete(uint8_t slot) noexcept {
+    return this->entries[slot].lenReceived >= this->entries[slot].lenContent;
+}
+
+uint8_t* Reassembler::getContent(uint8_t slot) noexcept {
+    return this->entries[slot].content;
+}
+
+uint32_t Reassembler::getLength(uint8_t slot) noexcept {
+    return this->entries[slot].lenContent;
+}
+
+void Reassembler::release(uint8_t slot) noexcept {
+    delete[] this->entries[slot].content;
+    delete[] this->entries[slot].receivedBits;
+    this->entries[slot].content = nullptr;
+    this->entries[slot].receivedBits = nullptr;
+}
+
+// "fragment" was accepted by "addFragment", so its header is valid
+void Reassembler::revertFragment(uint8_t slot, const uint8_t* fragment, uint16_t lenFragment) noexcept {
+    Entry& entry = this->entries[slot];
+    uint32_t offset;
+    memcpy(&offset, fragment + 8, sizeof(uint32_t));
+    entry.lenReceived -= markReceived(entry.receivedBits, offset, lenFragment - FRAGMENT_HEADER_SIZE, false);
+}
+
+//========
+// PRIVATE
+//========
+Reassembler::Entry* Reassembler::findEntry(const char* sender, uint32_t transferID, uint32_t lenMessage, uint64_t now) noexcept {
+    Entry* unused = nullptr;
+    for (uint8_t idx = 0; idx < this->capacity; ++idx) {
+        Entry* entry = &this->entries[idx];
+        if (entry->content == nullptr) {
+            if (unused == nullptr) {
+                unused = entry;
+            }
+            continue;
+        }
+        if (entry->transferID == transferID && strcmp(entry->sender, sender) == 0) {
+            if (entry->lenContent == lenMessage) {
+                return entry;
+            }
+            // The sender was reset and uses the ID for another message
+            release(idx);
+            return entry;
+        }
+        // The rest of the message will never come
+        if (now - entry->updateTime >= this->timeout) {
+            release(idx);
+            if (unused == nullptr) {
+                unused = entry;
+            }
+        }
+    }
+    return unused;
+}
+
+// Sets or clears the bits of ["offset", "offset" + "length"), returns the number of changed bits
+uint32_t Reassembler::markReceived(uint32_t* receivedBits, uint32_t offset, uint32_t length, bool isReceived) noexcept {
+    uint32_t numberChanged = 0;
+    while (length > 0) {
+        uint32_t shift = offset % NUMBER_BITS;
+        uint32_t count = NUMBER_BITS - shift;
+        if (count > length) {
+            count = length;
+        }
+        uint32_t mask = count == NUMBER_BITS ? 0xFFFFFFFFU : ((0x01U << count) - 1) << shift;
+        uint32_t& word = receivedBits[offset / NUMBER_BITS];
+        uint32_t changed = isReceived ? (~word & mask) : (word & mask);
+        numberChanged += __builtin_popcount(changed);
+        word ^= changed;
+        offset += count;
+        length -= count;
+    }
+    return numberChanged;
+}
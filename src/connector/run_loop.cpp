@@ -0,0 +1,60 @@
+#include "cso_connector/run_loop.h"
+
+#define DEFAULT_MIN_BACKOFF 3000 // (milli seconds)
+#define DEFAULT_MAX_BACKOFF 60000 // (milli seconds)
+#define NETWORK_CHECK_INTERVAL 1000 // (milli seconds)
+// The activation is sent again if the hub does not answer
+#define ACTIVATION_INTERVAL 3000 // (milli seconds)
+
+RunLoop::RunLoop() noexcept
+    : RunLoop(DEFAULT_MIN_BACKOFF, DEFAULT_MAX_BACKOFF) {}
+
+RunLoop::RunLoop(uint32_t minBackoff, uint32_t maxBackoff) noexcept
+    : stage(Offline),
+      nextTime(0),
+      backoff(minBackoff),
+      minBackoff(minBackoff),
+      maxBackoff(maxBackoff >= minBackoff ? maxBackoff : minBackoff) {}
+
+RunLoop::Stage RunLoop::getStage() const noexcept {
+    return this->stage;
+}
+
+uint64_t RunLoop::getNextTime() const noexcept {
+    return this->nextTime;
+}
+
+bool RunLoop::isDue(uint64_t now) const noexcept {
+    return now >= this->nextTime;
+}
+
+void RunLoop::onNetworkDown(uint64_t now) noexcept {
+    this->stage = Offline;
+    this->nextTime = now + NETWORK_CHECK_INTERVAL * 1000ULL;
+}
+
+void RunLoop::onConnectFailed(uint64_t now) noexcept {
+    this->stage = Offline;
+    this->nextTime = now + this->backoff * 1000ULL;
+    this->backoff = this->backoff <= this->maxBackoff / 2 ? this->backoff * 2 : this->maxBackoff;
+}
+
+void RunLoop::onConnected(uint64_t now) noexcept {
+    this->stage = Activating;
+    this->nextTime = now;
+}
+
+void RunLoop::onActivationSent(uint64_t now) noexcept {
+    this->nextTime = now + ACTIVATION_INTERVAL * 1000ULL;
+}
+
+void RunLoop::onActivated() noexcept {
+    this->stage = Active;
+    this->nextTime = UINT64_MAX;
+    this->backoff = this->minBackoff;
+}
+
+void RunLoop::onDisconnected(uint64_t now) noexcept {
+    this->stage = Offline;
+    this->nextTime = now;
+}
@@ -0,0 +1,37 @@
+#include "cso_connector/send_window.h"
+#include "message/define.h"
+
+#define DEFAULT_MAX_FRAMES 16
+#define DEFAULT_MAX_BYTES 4096
+#define DEFAULT_MAX_IN_FLIGHT 32
+// A fragment in its envelope fits 1 KB, the frame buffer of receivers on older firmware
+#define DEFAULT_MAX_FRAGMENT_SIZE (1024 - MAX_ENVELOPE_SIZE)
+#define DEFAULT_MAX_ACKS 8
+#define DEFAULT_ACK_DELAY 5 // (milli seconds)
+
+SendWindow::SendWindow() noexcept
+    : maxFrames(DEFAULT_MAX_FRAMES),
+      maxBytes(DEFAULT_MAX_BYTES),
+      maxInFlight(DEFAULT_MAX_IN_FLIGHT),
+      isCongestionControlled(false),
+      maxFragmentSize(DEFAULT_MAX_FRAGMENT_SIZE),
+      maxAcks(DEFAULT_MAX_ACKS),
+      ackDelay(DEFAULT_ACK_DELAY) {}
+
+SendWindow::SendWindow(uint16_t maxFrames, uint32_t maxBytes, uint32_t maxInFlight) noexcept
+    : maxFrames(maxFrames),
+      maxBytes(maxBytes),
+      maxInFlight(maxInFlight),
+      isCongestionControlled(false),
+      maxFragmentSize(DEFAULT_MAX_FRAGMENT_SIZE),
+      maxAcks(DEFAULT_MAX_ACKS),
+      ackDelay(DEFAULT_ACK_DELAY) {}
+
+SendWindow::SendWindow(uint16_t maxFrames, uint32_t maxBytes, uint32_t maxInFlight, uint16_t maxFragmentSize) noexcept
+    : maxFrames(maxFrames),
+      maxBytes(maxBytes),
+      maxInFlight(maxInFlight),
+      isCongestionControlled(false),
+      maxFragmentSize(maxFragmentSize),
+      maxAcks(DEFAULT_MAX_ACKS),
+      ackDelay(DEFAULT_ACK_DELAY) {}
@@ -0,0 +1,256 @@
+#include <new>
+#include <cstring>
+#include "cso_connector/subscription_table.h"
+
+#define NONE 0xFFFFU
+#define DEFAULT_MAX_TOPICS 16
+#define DEFAULT_MAX_SUBSCRIBERS 32
+
+std::unique_ptr<SubscriptionTable> SubscriptionTable::build() {
+    return SubscriptionTable::build(DEFAULT_MAX_TOPICS, DEFAULT_MAX_SUBSCRIBERS);
+}
+
+// "maxTopics" and "maxSubscribers" are in [1, 65534]
+std::unique_ptr<SubscriptionTable> SubscriptionTable::build(uint16_t maxTopics, uint16_t maxSubscribers) {
+    return std::unique_ptr<SubscriptionTable>(new SubscriptionTable(maxTopics, maxSubscribers));
+}
+
+SubscriptionTable::SubscriptionTable(uint16_t maxTopics, uint16_t maxSubscribers)
+    : maxTopics(maxTopics),
+      maxSubscribers(maxSubscribers),
+      topics(nullptr),
+      subscribers(nullptr),
+      snapshot(nullptr),
+      spin(),
+      freeTopics(nullptr),
+      numberFreeTopics(0),
+      freeSubscribers(nullptr),
+      numberFreeSubscribers(0),
+      slots(nullptr),
+      slotMask(0),
+      generation(1) {
+    if (this->maxTopics == 0 || this->maxTopics == NONE || this->maxSubscribers == 0 || this->maxSubscribers == NONE) {
+        throw "[cso_connector/SubscriptionTable(uint16_t maxTopics, uint16_t maxSubscribers)]Capacity has to be in [1, 65534]";
+    }
+
+    // Keep the index at most half full
+    uint32_t numberSlots = 1;
+    while (numberSlots < 2U * this->maxTopics) {
+        numberSlots <<= 1;
+    }
+    this->slotMask = numberSlots - 1;
+
+    this->topics = new (std::nothrow) Topic[this->maxTopics];
+    this->subscribers = new (std::nothrow) Subscriber[this->maxSubscribers];
+    this->snapshot = new (std::nothrow) Subscriber[this->maxSubscribers];
+    this->freeTopics = new (std::nothrow) uint16_t[this->maxTopics];
+    this->freeSubscribers = new (std::nothrow) uint16_t[this->maxSubscribers];
+    this->slots = new (std::nothrow) uint16_t[numberSlots];
+    if (this->topics == nullptr || this->subscribers == nullptr || this->snapshot == nullptr ||
+        this->freeTopics == nullptr || this->freeSubscribers == nullptr || this->slots == nullptr) {
+        delete[] this->topics;
+        delete[] this->subscribers;
+        delete[] this->snapshot;
+        delete[] this->freeTopics;
+        delete[] this->freeSubscribers;
+        delete[] this->slots;
+        throw "[cso_connector/SubscriptionTable(uint16_t maxTopics, uint16_t maxSubscribers)]Not enough memory to create array";
+    }
+
+    // Lower indexes are taken first
+    for (uint16_t idx = 0; idx < this->maxTopics; ++idx) {
+        this->freeTopics[idx] = this->maxTopics - 1 - idx;
+    }
+    for (uint16_t idx = 0; idx < this->maxSubscribers; ++idx) {
+        this->subscribers[idx].subscriptionID = 0;
+        this->freeSubscribers[idx] = this->maxSubscribers - 1 - idx;
+    }
+    for (uint32_t slot = 0; slot < numberSlots; ++slot) {
+        this->slots[slot] = NONE;
+    }
+    this->numberFreeTopics = this->maxTopics;
+    this->numberFreeSubscribers = this->maxSubscribers;
+}
+
+SubscriptionTable::~SubscriptionTable() noexcept {
+    delete[] this->topics;
+    delete[] this->subscribers;
+    delete[] this->snapshot;
+    delete[] this->freeTopics;
+    delete[] this->freeSubscribers;
+    delete[] this->slots;
+}
+
+Result<uint32_t> SubscriptionTable::subscribe(bool isGroup, const char* name, MessageHandler handler, void* context) noexcept {
+    uint8_t lenName = strnlen(name, MAX_CONNECTION_NAME_LENGTH + 1);
+    if (lenName == 0 || lenName > MAX_CONNECTION_NAME_LENGTH) {
+        return Result<uint32_t>(Error::Message_InvalidConnectionName, 0);
+    }
+    uint32_t hash = hashName(isGroup, name, lenName);
+
+    this->spin.lock();
+    uint16_t topicIdx = findTopic(isGroup, name, lenName, hash);
+    if (this->numberFreeSubscribers == 0 || (topicIdx == NONE && this->numberFreeTopics == 0)) {
+        this->spin.unlock();
+        return Result<uint32_t>(Error::CSOConnector_SubscriptionFull, 0);
+    }
+    if (topicIdx == NONE) {
+        topicIdx = addTopic(isGroup, name, lenName, hash);
+    }
+
+    uint16_t idx = this->freeSubscribers[--this->numberFreeSubscribers];
+    // A subscription ID modulo "maxSubscribers" is the index of its subscriber
+    if (this->generation >= UINT32_MAX / this->maxSubscribers) {
+        this->generation = 1;
+    }
+    uint32_t subscriptionID = this->generation++ * this->maxSubscribers + idx;
+
+    Subscriber& subscriber = this->subscribers[idx];
+    subscriber.subscriptionID = subscriptionID;
+    subscriber.topic = topicIdx;
+    subscriber.handler = handler;
+    subscriber.context = context;
+    subscriber.next = NONE;
+
+    Topic& topic = this->topics[topicIdx];
+    if (topic.tail == NONE) {
+        topic.head = idx;
+    } else {
+        this->subscribers[topic.tail].next = idx;
+    }
+    topic.tail = idx;
+    topic.numberSubscribers++;
+    this->spin.unlock();
+    return Result<uint32_t>(Error::Nil, subscriptionID);
+}
+
+void SubscriptionTable::unsubscribe(uint32_t subscriptionID) noexcept {
+    if (subscriptionID == 0) {
+        return;
+    }
+    uint16_t idx = subscriptionID % this->maxSubscribers;
+
+    this->spin.lock();
+    Subscriber& subscriber = this->subscribers[idx];
+    if (subscriber.subscriptionID != subscriptionID) {
+        this->spin.unlock();
+        return;
+    }
+
+    Topic& topic = this->topics[subscriber.topic];
+    uint16_t prev = NONE;
+    for (uint16_t cur = topic.head; cur != idx; cur = this->subscribers[cur].next) {
+        prev = cur;
+    }
+    if (prev == NONE) {
+        topic.head = subscriber.next;
+    } else {
+        this->subscribers[prev].next = subscriber.next;
+    }
+    if (topic.tail == idx) {
+        topic.tail = prev;
+    }
+    topic.numberSubscribers--;
+    if (topic.numberSubscribers == 0) {
+        removeTopic(subscriber.topic);
+    }
+
+    subscriber.subscriptionID = 0;
+    this->freeSubscribers[this->numberFreeSubscribers++] = idx;
+    this->spin.unlock();
+}
+
+bool SubscriptionTable::dispatch(bool isGroup, const char* name, uint8_t* data, uint16_t lenData, Error::Code& error) noexcept {
+    uint8_t lenName = strnlen(name, MAX_CONNECTION_NAME_LENGTH + 1);
+    if (lenName > MAX_CONNECTION_NAME_LENGTH) {
+        return false;
+    }
+    uint32_t hash = hashName(isGroup, name, lenName);
+
+    // Handlers can subscribe or unsubscribe, so they run on a copy of the list
+    uint16_t numberHandlers = 0;
+    this->spin.lock();
+    uint16_t topicIdx = findTopic(isGroup, name, lenName, hash);
+    if (topicIdx != NONE) {
+        for (uint16_t idx = this->topics[topicIdx].head; idx != NONE; idx = this->subscribers[idx].next) {
+            this->snapshot[numberHandlers++] = this->subscribers[idx];
+        }
+    }
+    this->spin.unlock();
+    if (numberHandlers == 0) {
+        return false;
+    }
+
+    error = Error::Nil;
+    for (uint16_t idx = 0; idx < numberHandlers; ++idx) {
+        Error::Code result = this->snapshot[idx].handler(name, data, lenData, this->snapshot[idx].context);
+        if (result != Error::Nil && error == Error::Nil) {
+            error = result;
+        }
+    }
+    return true;
+}
+
+//========
+// PRIVATE
+//========
+// FNV-1a, groups and senders with the same name are different topics
+uint32_t SubscriptionTable::hashName(bool isGroup, const char* name, uint8_t lenName) noexcept {
+    uint32_t hash = 2166136261U;
+    hash ^= isGroup ? 1U : 0U;
+    hash *= 16777619U;
+    for (uint8_t idx = 0; idx < lenName; ++idx) {
+        hash ^= (uint8_t)name[idx];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+uint16_t SubscriptionTable::findTopic(bool isGroup, const char* name, uint8_t lenName, uint32_t hash) noexcept {
+    for (uint32_t slot = hash & this->slotMask; this->slots[slot] != NONE; slot = (slot + 1) & this->slotMask) {
+        Topic& topic = this->topics[this->slots[slot]];
+        if (topic.hash == hash && topic.isGroup == isGroup && topic.lenName == lenName && memcmp(topic.name, name, lenName) == 0) {
+            return this->slots[slot];
+        }
+    }
+    return NONE;
+}
+
+uint16_t SubscriptionTable::addTopic(bool isGroup, const char* name, uint8_t lenName, uint32_t hash) noexcept {
+    uint16_t idx = this->freeTopics[--this->numberFreeTopics];
+    Topic& topic = this->topics[idx];
+    memcpy(topic.name, name, lenName);
+    topic.name[lenName] = '\0';
+    topic.lenName = lenName;
+    topic.isGroup = isGroup;
+    topic.hash = hash;
+    topic.head = NONE;
+    topic.tail = NONE;
+    topic.numberSubscribers = 0;
+
+    uint32_t slot = hash & this->slotMask;
+    while (this->slots[slot] != NONE) {
+        slot = (slot + 1) & this->slotMask;
+    }
+    this->slots[slot] = idx;
+    return idx;
+}
+
+// Removes the topic from the index by backward shift deletion (no tombstones)
+void SubscriptionTable::removeTopic(uint16_t idx) noexcept {
+    uint32_t hole = this->topics[idx].hash & this->slotMask;
+    while (this->slots[hole] != idx) {
+        hole = (hole + 1) & this->slotMask;
+    }
+
+    for (uint32_t slot = (hole + 1) & this->slotMask; this->slots[slot] != NONE; slot = (slot + 1) & this->slotMask) {
+        uint32_t home = this->topics[this->slots[slot]].hash & this->slotMask;
+        // The topic can fill the hole if its home is not in ("hole", "slot"]
+        if (((slot - home) & this->slotMask) >= ((slot - hole) & this->slotMask)) {
+            this->slots[hole] = this->slots[slot];
+            hole = slot;
+        }
+    }
+    this->slots[hole] = NONE;
+    this->freeTopics[this->numberFreeTopics++] = idx;
+}
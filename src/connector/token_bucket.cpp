@@ -0,0 +1,64 @@
+#include "cso_connector/token_bucket.h"
+
+#define SCALE 1000000LL
+
+TokenBucket::TokenBucket() noexcept
+    : rate(0),
+      burst(1),
+      credit(SCALE),
+      updateTime(0) {}
+
+void TokenBucket::reset(uint32_t rate, uint32_t burst, uint64_t now) noexcept {
+    this->rate = rate;
+    this->burst = burst > 0 ? burst : 1;
+    this->credit = this->burst * SCALE;
+    this->updateTime = now;
+}
+
+bool TokenBucket::isLimited() const noexcept {
+    return this->rate > 0;
+}
+
+bool TokenBucket::hasTokens(uint32_t number, uint64_t now) noexcept {
+    if (this->rate == 0) {
+        return true;
+    }
+    if (now > this->updateTime) {
+        // A full bucket is refilled within "burst" / "rate" seconds, longer times add nothing
+        uint64_t elapsed = now - this->updateTime;
+        uint64_t maxElapsed = (uint64_t)this->burst * SCALE / this->rate + 1;
+        if (elapsed > maxElapsed) {
+            elapsed = maxElapsed;
+        }
+        this->credit += (int64_t)(elapsed * this->rate);
+        if (this->credit > this->burst * SCALE) {
+            this->credit = this->burst * SCALE;
+        }
+        this->updateTime = now;
+    }
+    uint32_t needed = number < this->burst ? number : this->burst;
+    return this->credit >= needed * SCALE;
+}
+
+void TokenBucket::take(uint32_t number) noexcept {
+    if (this->rate == 0) {
+        return;
+    }
+    this->credit -= number * SCALE;
+}
+
+uint64_t TokenBucket::readyTime(uint32_t number) const noexcept {
+    if (this->rate == 0) {
+        return 0;
+    }
+    uint32_t needed = number < this->burst ? number : this->burst;
+    int64_t missing = needed * SCALE - this->credit;
+    if (missing <= 0) {
+        return this->updateTime;
+    }
+    return this->updateTime + ((uint64_t)missing + this->rate - 1) / this->rate;
+}
+
+uint64_t TokenBucket::getUpdateTime() const noexcept {
+    return this->updateTime;
+}
@@ -1,19 +1,35 @@
-// #include <lwip/sockets.h>
 #include <new>
 #include "cso_connection/connection.h"
 
 #define HEADER_SIZE 2
-#define BUFFER_SIZE 1024
 
 std::unique_ptr<IConnection> Connection::build(uint16_t queueSize) {
-    return std::unique_ptr<IConnection>(new Connection(queueSize));
+    return Connection::build(queueSize, Poller::build());
 }
 
-Connection::Connection(uint16_t queueSize) 
+std::unique_ptr<IConnection> Connection::build(uint16_t queueSize, std::shared_ptr<Poller> poller) {
+    return std::unique_ptr<IConnection>(new Connection(queueSize, poller));
+}
+
+Connection::Connection(uint16_t queueSize, std::shared_ptr<Poller>& poller) 
     : nextMessage(queueSize),
-      status(Status::Prepare) {}
+      status(Status::Prepare),
+      header(),
+      message(nullptr),
+      isHeader(true),
+      seek(0),
+      length(HEADER_SIZE),
+      poller(poller),
+      socket(-1) {
+    if (this->poller == nullptr) {
+        throw "[cso_connection/Connection(uint16_t queueSize, std::shared_ptr<Poller>& poller)]Poller is nullptr";
+    }
+}
 
 Connection::~Connection() noexcept {
+    if (this->socket >= 0) {
+        this->poller->remove(this->socket);
+    }
     this->client.stop();
 }
 
@@ -21,6 +37,11 @@ Error::Code Connection::connect(const char* host, uint16_t port) {
     if (this->status.load() == Status::Connected) {
         return Error::Nil;
     }
+    // The socket of a connection which was closed on another task is still in "poller"
+    if (this->socket >= 0) {
+        this->poller->remove(this->socket);
+        this->socket = -1;
+    }
     uint8_t retry = 0;
     while (!client.connect(host, port)) {
         if (++retry >= 2) {
@@ -29,86 +50,82 @@ Error::Code Connection::connect(const char* host, uint16_t port) {
         vTaskDelay(100);
     }
 
-    if (!setup()) {
+    if (!setup() || !this->poller->add(this->client.fd())) {
+        this->client.stop();
         return Error::CSOConnection_SetupFailed;
     }
+    this->socket = this->client.fd();
+    this->message.reset();
+    this->isHeader = true;
+    this->seek = 0;
+    this->length = HEADER_SIZE;
     this->status.store(Status::Connected);
     return Error::Nil;
 }
 
-Error::Code Connection::loopListen() {
-    std::unique_ptr<uint8_t> buffer(new (std::nothrow) uint8_t[BUFFER_SIZE]);
-    if (buffer == nullptr) {
-        return Error::NotEnoughMemory;
+Error::Code Connection::receive() {
+    if (this->status.load() != Status::Connected) {
+        // "writeBuffer" closed the socket on another task
+        disconnect();
+        return Error::CSOConnection_Disconnected;
+    }
+    if (WiFi.status() != WL_CONNECTED) {
+        disconnect();
+        return Error::CSOConnection_Disconnected;
     }
 
-    bool header = true;
-    // bool disconnected = true;
-    uint8_t* message = nullptr;
-    uint16_t seek = 0;
-    uint16_t readed = 0;
-    uint16_t length = HEADER_SIZE;
-
-    while (WiFi.status() == WL_CONNECTED && this->status.load() == Status::Connected) {
-        if (this->client.available() <= 0) {
-            // disconnected = false;
-            // break;
-            vTaskDelay(50 / portTICK_PERIOD_MS);
-            continue;
+    int available;
+    while ((available = this->client.available()) > 0) {
+        // "seek" always is < "length"
+        size_t lenRead = this->length - this->seek;
+        if (lenRead > (size_t)available) {
+            lenRead = available;
         }
-
-        // "readed" always is <= "length - seek"
-        readed = this->client.readBytes(buffer.get() + seek, length - seek);
+        uint8_t* buffer = this->isHeader ? this->header : this->message.get();
+        int readed = this->client.read(buffer + this->seek, lenRead);
         if (readed <= 0) {
-            // disconnected = false;
-            // break;
-            vTaskDelay(50 / portTICK_PERIOD_MS);
-            continue;
+            break;
         }
 
         // Read enough data
-        seek += readed;
-        if (seek < length) {
+        this->seek += readed;
+        if (this->seek < this->length) {
             continue;
         }
 
-        // Read "data length"
-        if (header) {
-            length = (buffer.get()[1] << 8U) | buffer.get()[0];
-            if (length > 0) {
-                header = false;
+        // Read "data length", any length of the 2 bytes is read
+        if (this->isHeader) {
+            this->length = (this->header[1] << 8U) | this->header[0];
+            if (this->length > 0) {
+                this->message.reset(new (std::nothrow) uint8_t[this->length]);
+                if (this->message == nullptr) {
+                    disconnect();
+                    return Error::NotEnoughMemory;
+                }
+                this->isHeader = false;
+            } else {
+                this->length = HEADER_SIZE;
             }
-            seek = 0;
+            this->seek = 0;
             continue;
         }
 
-        // Build "message"
-        message = new (std::nothrow) uint8_t[length];
-        if (message == nullptr) {
-            return Error::NotEnoughMemory;
-        }
-
         // Push message
-        // Don't delete "message" because queue will manage memory
-        memcpy(message, buffer.get(), length);
-        this->nextMessage.push(Array<uint8_t>(message, length));
+        // The queue manages the memory of "message" now
+        this->nextMessage.push(Array<uint8_t>(this->message.release(), this->length));
 
-        // disconnected = false;
-        // break;
         // Reset
-        length = HEADER_SIZE;
-        header = true;
-        seek = 0;
+        this->length = HEADER_SIZE;
+        this->isHeader = true;
+        this->seek = 0;
     }
-    this->client.stop();
-    this->status.store(Status::Disconnected);
-    return Error::CSOConnection_Disconnected;
-    // if (disconnected) {
-    //     this->client.stop();        
-    //     this->status = Status::Disconnected;
-    //     return Error::CSOConnection_Disconnected;
-    // }
-    // return Error::Nil;
+
+    // A socket which is readable without data is closed by the hub
+    if (!this->client.connected()) {
+        disconnect();
+        return Error::CSOConnection_Disconnected;
+    }
+    return Error::Nil;
 }
 
 Error::Code Connection::sendMessage(uint8_t* data, uint16_t nBytes) {
@@ -120,19 +137,74 @@ Error::Code Connection::sendMessage(uint8_t* data, uint16_t nBytes) {
     //============
     // Make buffer
     //============
-    std::unique_ptr<uint8_t> buffer(new (std::nothrow) uint8_t[nBytes + HEADER_SIZE]); // Add 2 bytes "data length"
+    std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[nBytes + HEADER_SIZE]); // Add 2 bytes "data length"
     if (buffer == nullptr) {
         return Error::NotEnoughMemory;
     }
     memcpy(buffer.get(), &nBytes, sizeof(uint16_t));
     memcpy(buffer.get() + HEADER_SIZE, data, nBytes);
+    return writeBuffer(buffer.get(), nBytes + HEADER_SIZE);
+}
+
+Error::Code Connection::sendMessages(Array<uint8_t>* messages, uint16_t numberMessages) {
+    if (WiFi.status() != WL_CONNECTED || this->status.load() != Status::Connected) {
+        this->status = Status::Disconnected;
+        return Error::CSOConnection_Disconnected;
+    }
+
+    //============
+    // Make buffer
+    //============
+    size_t nBytes = 0;
+    for (uint16_t idx = 0; idx < numberMessages; ++idx) {
+        if (messages[idx].length > UINT16_MAX) {
+            return Error::CSOConnection_InvalidLength;
+        }
+        nBytes += messages[idx].length + HEADER_SIZE;
+    }
+    std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[nBytes]);
+    if (buffer == nullptr) {
+        return Error::NotEnoughMemory;
+    }
+    uint8_t* seek = buffer.get();
+    for (uint16_t idx = 0; idx < numberMessages; ++idx) {
+        uint16_t length = messages[idx].length;
+        memcpy(seek, &length, sizeof(uint16_t));
+        memcpy(seek + HEADER_SIZE, messages[idx].buffer.get(), length);
+        seek += length + HEADER_SIZE;
+    }
+    return writeBuffer(buffer.get(), nBytes);
+}
+
+Array<uint8_t> Connection::getMessage() {
+    return this->nextMessage.pop().data;
+}
+
+uint32_t Connection::getMessages(Array<uint8_t>* messages, uint32_t max) {
+    return this->nextMessage.popBatch(messages, max);
+}
 
+bool Connection::hasMessages() {
+    return !this->nextMessage.empty();
+}
+
+bool Connection::waitMessage(uint32_t timeout) {
+    if (!this->nextMessage.empty()) {
+        return true;
+    }
+    return this->poller->wait(timeout);
+}
+
+void Connection::wakeUp() {
+    this->poller->wakeUp();
+}
+
+Error::Code Connection::writeBuffer(uint8_t* buffer, size_t nBytes) {
     //===============
     // Send and check
     //=============== 
-    nBytes += HEADER_SIZE;
     for (size_t seek = 0, sent = 0; seek < nBytes; seek += sent) {
-        sent = this->client.write(buffer.get() + seek, nBytes - seek);
+        sent = this->client.write(buffer + seek, nBytes - seek);
         if (sent == 0) {
             this->client.stop();
             this->status.store(Status::Disconnected);
@@ -142,10 +214,6 @@ Error::Code Connection::sendMessage(uint8_t* data, uint16_t nBytes) {
     return Error::Nil;
 }
 
-Array<uint8_t> Connection::getMessage() {
-    return this->nextMessage.pop().data;
-}
-
 bool Connection::setup() noexcept {
     // timeout 20s for read + write
     if (this->client.setTimeout(20) != ESP_OK) {
@@ -158,4 +226,17 @@ bool Connection::setup() noexcept {
         return false;
     }
     return true;
+}
+
+void Connection::disconnect() noexcept {
+    if (this->socket >= 0) {
+        this->poller->remove(this->socket);
+        this->socket = -1;
+    }
+    this->client.stop();
+    this->status.store(Status::Disconnected);
+    this->message.reset();
+    this->isHeader = true;
+    this->seek = 0;
+    this->length = HEADER_SIZE;
 }
\ No newline at end of file
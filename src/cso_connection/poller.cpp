@@ -0,0 +1,124 @@
+#include <new>
+#include <cstring>
+#include "cso_connection/poller.h"
+
+#define DEFAULT_MAX_SOCKETS 1
+
+std::shared_ptr<Poller> Poller::build() {
+    return Poller::build(DEFAULT_MAX_SOCKETS);
+}
+
+std::shared_ptr<Poller> Poller::build(uint16_t maxSockets) {
+    return std::shared_ptr<Poller>(new Poller(maxSockets));
+}
+
+Poller::Poller(uint16_t maxSockets)
+    : sockets(nullptr),
+      maxSockets(maxSockets),
+      numberSockets(0),
+      event(),
+      wakeSocket(-1),
+      isWoken(false),
+      wakeAddr() {
+    if (this->maxSockets == 0) {
+        throw "[cso_connection/Poller(uint16_t maxSockets)]Sockets have to be larger than 0";
+    }
+    this->sockets.reset(new (std::nothrow) int[this->maxSockets]);
+    if (this->sockets == nullptr) {
+        throw "[cso_connection/Poller(uint16_t maxSockets)]Not enough memory to create array";
+    }
+}
+
+Poller::~Poller() noexcept {
+    if (this->wakeSocket.load() >= 0) {
+        closesocket(this->wakeSocket.load());
+    }
+}
+
+bool Poller::add(int socket) noexcept {
+    if (this->numberSockets == this->maxSockets) {
+        return false;
+    }
+    if (this->wakeSocket.load() < 0 && !openWakeSocket()) {
+        return false;
+    }
+    this->sockets[this->numberSockets++] = socket;
+    return true;
+}
+
+void Poller::remove(int socket) noexcept {
+    for (uint16_t idx = 0; idx < this->numberSockets; ++idx) {
+        if (this->sockets[idx] == socket) {
+            this->sockets[idx] = this->sockets[--this->numberSockets];
+            return;
+        }
+    }
+}
+
+bool Poller::wait(uint32_t timeout) noexcept {
+    int wake = this->wakeSocket.load();
+    if (this->numberSockets == 0 || wake < 0) {
+        return this->event.wait(timeout);
+    }
+
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(wake, &readSet);
+    int maxSocket = wake;
+    for (uint16_t idx = 0; idx < this->numberSockets; ++idx) {
+        FD_SET(this->sockets[idx], &readSet);
+        if (this->sockets[idx] > maxSocket) {
+            maxSocket = this->sockets[idx];
+        }
+    }
+    struct timeval interval;
+    interval.tv_sec = timeout / 1000;
+    interval.tv_usec = (timeout % 1000) * 1000;
+    int ready = select(maxSocket + 1, &readSet, nullptr, nullptr, timeout == UINT32_MAX ? nullptr : &interval);
+    if (ready == 0) {
+        return false;
+    }
+    // A socket which is closed on another task gives an error, its connection finds it on "receive"
+    if (ready > 0 && FD_ISSET(wake, &readSet)) {
+        // The byte is read before "isWoken" is cleared, otherwise a "wakeUp" in between is lost
+        uint8_t bytes[8];
+        while (recv(wake, bytes, sizeof(bytes), MSG_DONTWAIT) > 0) {}
+        this->isWoken.store(false);
+    }
+    return true;
+}
+
+void Poller::wakeUp() noexcept {
+    this->event.notify();
+    int wake = this->wakeSocket.load();
+    if (wake < 0 || this->isWoken.exchange(true)) {
+        return;
+    }
+    uint8_t byte = 0;
+    sendto(wake, &byte, 1, 0, (struct sockaddr*)&this->wakeAddr, sizeof(this->wakeAddr));
+}
+
+//========
+// PRIVATE
+//========
+bool Poller::openWakeSocket() noexcept {
+    // The socket sends to itself on the loopback interface
+    int wake = socket(AF_INET, SOCK_DGRAM, 0);
+    if (wake < 0) {
+        return false;
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = 0;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t lenAddr = sizeof(addr);
+    if (bind(wake, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        getsockname(wake, (struct sockaddr*)&addr, &lenAddr) < 0) {
+        closesocket(wake);
+        return false;
+    }
+    this->wakeAddr = addr;
+    this->wakeSocket.store(wake);
+    return true;
+}
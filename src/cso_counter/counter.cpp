@@ -1,52 +1,51 @@
 #include <new>
 #include "cso_counter/counter.h"
 
-#define NUMBER_BITS 32
+#define HALF_BIT 0x80000000U
+#define QUARTER_BIT 0x40000000U
 
-std::unique_ptr<ICounter> Counter::build(uint64_t writeIndex, uint64_t minReadIndex, uint32_t maskReadBits) {
-    return std::unique_ptr<ICounter>(new Counter(writeIndex - 1, minReadIndex, maskReadBits));
+std::unique_ptr<ICounter> Counter::build(uint64_t writeIndex) {
+    return std::unique_ptr<ICounter>(new Counter(writeIndex - 1));
 }
 
-Counter::Counter(uint64_t writeIndex, uint64_t minReadIndex, uint32_t maskReadBits) noexcept
-    : spin(),
-      writeIndex(writeIndex - 1),
-      minReadIndex(minReadIndex),
-      maskReadBits(maskReadBits) {}
+Counter::Counter(uint64_t writeIndex) noexcept
+    : baseWriteIndex(0),
+      lowWriteIndex(0),
+      halfEpochs(0) {
+    uint64_t firstWriteIndex = writeIndex - 1;
+    uint32_t low = (uint32_t)firstWriteIndex;
+    uint32_t epochs = (low & HALF_BIT) != 0 ? 1 : 0;
+    // The first writer will count the crossing itself
+    if ((low & ~HALF_BIT) == 0) {
+        epochs--;
+    }
+    this->baseWriteIndex = firstWriteIndex & 0xFFFFFFFF00000000ULL;
+    this->lowWriteIndex.store(low);
+    this->halfEpochs.store(epochs);
+}
 
 Counter::~Counter() noexcept {}
 
 uint64_t Counter::nextWriteIndex() noexcept {
-    this->spin.lock();
-    uint64_t ret = this->writeIndex;
-    this->writeIndex += 1;
-    this->spin.unlock();
-    return ret;
-}
-
-void Counter::markReadUnused(uint64_t index) noexcept {
-    if (index < this->minReadIndex) {
-        return;
-    }
-    if (index >= this->minReadIndex + NUMBER_BITS) {
-        return;
-    }
-    this->maskReadBits &= ~(0x01U << (index - this->minReadIndex));
-}
-
-bool Counter::markReadDone(uint64_t index) noexcept {
-    if (index < this->minReadIndex) {
-        return false;
+    uint32_t low = this->lowWriteIndex.fetch_add(1);
+    uint32_t epochs = this->halfEpochs.load();
+
+    // The parity of "halfEpochs" has to match the half which "low" is in.
+    // Otherwise "halfEpochs" is one step behind (the writer who crossed the half
+    // has not increased it yet) or one step ahead (this writer is late).
+    // It assumes that no writer is delayed by 2^30 other writers.
+    uint32_t half = (low & HALF_BIT) != 0 ? 1 : 0;
+    if ((epochs & 0x01U) != half) {
+        if ((low & QUARTER_BIT) == 0) {
+            epochs++;
+        } else {
+            epochs--;
+        }
     }
 
-    if (index >= this->minReadIndex + NUMBER_BITS) {
-        this->minReadIndex += NUMBER_BITS;
-        this->maskReadBits = 0;
+    // This writer is the first one in the new half
+    if ((low & ~HALF_BIT) == 0) {
+        this->halfEpochs.fetch_add(1);
     }
-    
-    uint32_t mask = 0x01U << (index - this->minReadIndex);
-	if ((this->maskReadBits & mask) != 0) {
-		return false;
-	}
-	this->maskReadBits |= mask;
-	return true;
-}
\ No newline at end of file
+    return this->baseWriteIndex + (((uint64_t)(epochs >> 1) << 32) | low);
+}
@@ -0,0 +1,111 @@
+#include <cstring>
+#include "cso_counter/read_window.h"
+
+#define NUMBER_BITS 32
+#define MIN_WINDOW_BITS 256
+#define MAX_WINDOW_BITS 4096
+
+uint32_t ReadWindow::roundWindowBits(uint32_t windowBits) noexcept {
+    if (windowBits < MIN_WINDOW_BITS) {
+        return MIN_WINDOW_BITS;
+    }
+    if (windowBits > MAX_WINDOW_BITS) {
+        return MAX_WINDOW_BITS;
+    }
+    return (windowBits + NUMBER_BITS - 1) / NUMBER_BITS * NUMBER_BITS;
+}
+
+ReadWindow::ReadWindow() noexcept
+    : minReadIndex(0),
+      windowBits(0),
+      readBits(nullptr) {}
+
+void ReadWindow::bind(uint32_t* readBits, uint32_t windowBits) noexcept {
+    this->readBits = readBits;
+    this->windowBits = windowBits;
+}
+
+void ReadWindow::reset(uint64_t minReadIndex, uint32_t maskReadBits) noexcept {
+    this->minReadIndex = minReadIndex;
+    memset(this->readBits, 0, this->windowBits / NUMBER_BITS * sizeof(uint32_t));
+    for (uint32_t bit = 0; bit < NUMBER_BITS; ++bit) {
+        if ((maskReadBits & (0x01U << bit)) != 0) {
+            uint32_t pos = (minReadIndex + bit) % this->windowBits;
+            this->readBits[pos / NUMBER_BITS] |= 0x01U << (pos % NUMBER_BITS);
+        }
+    }
+}
+
+void ReadWindow::markReadUnused(uint64_t index) noexcept {
+    if (index < this->minReadIndex) {
+        return;
+    }
+    if (index >= this->minReadIndex + this->windowBits) {
+        return;
+    }
+    uint32_t pos = index % this->windowBits;
+    this->readBits[pos / NUMBER_BITS] &= ~(0x01U << (pos % NUMBER_BITS));
+}
+
+bool ReadWindow::markReadDone(uint64_t index) noexcept {
+    if (index < this->minReadIndex) {
+        return false;
+    }
+
+    // Slide the window just enough to cover "index"
+    if (index >= this->minReadIndex + this->windowBits) {
+        uint64_t newMinReadIndex = index - this->windowBits + 1;
+        clearReadBits(this->minReadIndex, newMinReadIndex);
+        this->minReadIndex = newMinReadIndex;
+    }
+
+    uint32_t pos = index % this->windowBits;
+    uint32_t mask = 0x01U << (pos % NUMBER_BITS);
+    uint32_t& word = this->readBits[pos / NUMBER_BITS];
+	if ((word & mask) != 0) {
+		return false;
+	}
+	word |= mask;
+	return true;
+}
+
+bool ReadWindow::isReadDone(uint64_t index) const noexcept {
+    if (index < this->minReadIndex) {
+        return true;
+    }
+    if (index >= this->minReadIndex + this->windowBits) {
+        return false;
+    }
+    uint32_t pos = index % this->windowBits;
+    return (this->readBits[pos / NUMBER_BITS] & (0x01U << (pos % NUMBER_BITS))) != 0;
+}
+
+uint64_t ReadWindow::getMinReadIndex() const noexcept {
+    return this->minReadIndex;
+}
+
+//========
+// PRIVATE
+//========
+// Clears bits of indexes in ["fromIndex", "toIndex"), they are reused by the next indexes
+void ReadWindow::clearReadBits(uint64_t fromIndex, uint64_t toIndex) noexcept {
+    if (toIndex - fromIndex >= this->windowBits) {
+        memset(this->readBits, 0, this->windowBits / NUMBER_BITS * sizeof(uint32_t));
+        return;
+    }
+
+    uint32_t pos = fromIndex % this->windowBits;
+    uint32_t remain = toIndex - fromIndex;
+    while (remain > 0) {
+        uint32_t offset = pos % NUMBER_BITS;
+        uint32_t count = NUMBER_BITS - offset;
+        if (count > remain) {
+            count = remain;
+        }
+        // Clear "count" bits from "offset" in one operation
+        uint32_t mask = count == NUMBER_BITS ? 0xFFFFFFFFU : ((0x01U << count) - 1) << offset;
+        this->readBits[pos / NUMBER_BITS] &= ~mask;
+        pos = (pos + count) % this->windowBits;
+        remain -= count;
+    }
+}
@@ -0,0 +1,279 @@
+#include <new>
+#include <cstring>
+#include "cso_counter/sender_counter.h"
+
+#define NUMBER_BITS 32
+#define NONE 0xFFFFU
+#define DEFAULT_CAPACITY 32
+#define DEFAULT_WINDOW_BITS 256
+#define MARK_BITS 64
+// Evicted senders which are remembered, per entry of the table
+#define MARKS_PER_ENTRY 4
+// Slots which are looked at for a mark
+#define MARK_PROBES 4
+
+std::unique_ptr<SenderCounter> SenderCounter::build() {
+    return std::unique_ptr<SenderCounter>(new SenderCounter(DEFAULT_CAPACITY, DEFAULT_WINDOW_BITS));
+}
+
+// "capacity" is in [1, 65534], "windowBits" is rounded to a multiple of 32 in [256, 4096]
+std::unique_ptr<SenderCounter> SenderCounter::build(uint16_t capacity, uint32_t windowBits) {
+    return std::unique_ptr<SenderCounter>(new SenderCounter(capacity, windowBits));
+}
+
+SenderCounter::SenderCounter(uint16_t capacity, uint32_t windowBits)
+    : capacity(capacity),
+      numberEntries(0),
+      windowBits(ReadWindow::roundWindowBits(windowBits)),
+      entries(nullptr),
+      readBits(nullptr),
+      head(NONE),
+      tail(NONE),
+      slots(nullptr),
+      slotMask(0),
+      marks(nullptr),
+      markMask(0),
+      numberEvictions(0) {
+    if (this->capacity == 0 || this->capacity == NONE) {
+        throw "[cso_counter/SenderCounter(uint16_t capacity, uint32_t windowBits)]Capacity has to be in [1, 65534]";
+    }
+
+    // Keep the index at most half full
+    uint32_t numberSlots = 1;
+    while (numberSlots < 2U * this->capacity) {
+        numberSlots <<= 1;
+    }
+    this->slotMask = numberSlots - 1;
+    uint32_t numberMarks = 1;
+    while (numberMarks < MARKS_PER_ENTRY * (uint32_t)this->capacity || numberMarks < MARK_PROBES) {
+        numberMarks <<= 1;
+    }
+    this->markMask = numberMarks - 1;
+
+    uint32_t numberWords = this->windowBits / NUMBER_BITS;
+    this->entries = new (std::nothrow) Entry[this->capacity];
+    this->readBits = new (std::nothrow) uint32_t[this->capacity * numberWords];
+    this->slots = new (std::nothrow) uint16_t[numberSlots];
+    this->marks = new (std::nothrow) Mark[numberMarks];
+    if (this->entries == nullptr || this->readBits == nullptr || this->slots == nullptr || this->marks == nullptr) {
+        delete[] this->entries;
+        delete[] this->readBits;
+        delete[] this->slots;
+        delete[] this->marks;
+        throw "[cso_counter/SenderCounter(uint16_t capacity, uint32_t windowBits)]Not enough memory to create array";
+    }
+
+    for (uint16_t idx = 0; idx < this->capacity; ++idx) {
+        this->entries[idx].window.bind(this->readBits + idx * numberWords, this->windowBits);
+    }
+    for (uint32_t slot = 0; slot < numberSlots; ++slot) {
+        this->slots[slot] = NONE;
+    }
+    for (uint32_t slot = 0; slot < numberMarks; ++slot) {
+        this->marks[slot].nextIndex = 0;
+    }
+}
+
+SenderCounter::~SenderCounter() noexcept {
+    delete[] this->entries;
+    delete[] this->readBits;
+    delete[] this->slots;
+    delete[] this->marks;
+}
+
+void SenderCounter::markReadUnused(const char* sender, uint64_t index) noexcept {
+    uint8_t lenName = strnlen(sender, MAX_CONNECTION_NAME_LENGTH + 1);
+    uint16_t idx = findEntry(sender, lenName, hashName(sender, lenName));
+    if (idx == NONE) {
+        return;
+    }
+    this->entries[idx].window.markReadUnused(index);
+}
+
+bool SenderCounter::markReadDone(const char* sender, uint64_t index) noexcept {
+    uint8_t lenName = strnlen(sender, MAX_CONNECTION_NAME_LENGTH + 1);
+    if (lenName == 0 || lenName > MAX_CONNECTION_NAME_LENGTH) {
+        return false;
+    }
+
+    uint64_t hash = hashName(sender, lenName);
+    uint16_t idx = findEntry(sender, lenName, hash);
+    if (idx == NONE) {
+        idx = addEntry(sender, lenName, hash);
+        loadMark(idx, index);
+    }
+    touchEntry(idx);
+    return this->entries[idx].window.markReadDone(index);
+}
+
+//========
+// PRIVATE
+//========
+// FNV-1a, 64 bits so marks (which keep no name) of two senders do not collide
+uint64_t SenderCounter::hashName(const char* name, uint8_t lenName) noexcept {
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint8_t idx = 0; idx < lenName; ++idx) {
+        hash ^= (uint8_t)name[idx];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint16_t SenderCounter::findEntry(const char* name, uint8_t lenName, uint64_t hash) noexcept {
+    for (uint32_t slot = hash & this->slotMask; this->slots[slot] != NONE; slot = (slot + 1) & this->slotMask) {
+        Entry& entry = this->entries[this->slots[slot]];
+        if (entry.hash == hash && entry.lenName == lenName && memcmp(entry.name, name, lenName) == 0) {
+            return this->slots[slot];
+        }
+    }
+    return NONE;
+}
+
+uint16_t SenderCounter::addEntry(const char* name, uint8_t lenName, uint64_t hash) noexcept {
+    uint16_t idx;
+    if (this->numberEntries < this->capacity) {
+        idx = this->numberEntries++;
+    } else {
+        // Evict the least recently used sender, its retries are still known by its mark
+        idx = this->tail;
+        saveMark(idx);
+        removeSlot(idx);
+        unlinkEntry(idx);
+    }
+
+    Entry& entry = this->entries[idx];
+    memcpy(entry.name, name, lenName);
+    entry.name[lenName] = '\0';
+    entry.lenName = lenName;
+    entry.hash = hash;
+    entry.prev = NONE;
+    entry.next = NONE;
+
+    uint32_t slot = hash & this->slotMask;
+    while (this->slots[slot] != NONE) {
+        slot = (slot + 1) & this->slotMask;
+    }
+    this->slots[slot] = idx;
+    return idx;
+}
+
+SenderCounter::Mark* SenderCounter::findMark(uint64_t hash) noexcept {
+    for (uint32_t probe = 0; probe < MARK_PROBES; ++probe) {
+        Mark& slot = this->marks[(hash + probe) & this->markMask];
+        if (slot.nextIndex != 0 && slot.hash == hash) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+// Keeps the highest read index of the window of the entry and the 64 indexes under it
+void SenderCounter::saveMark(uint16_t idx) noexcept {
+    const Entry& entry = this->entries[idx];
+    uint64_t minReadIndex = entry.window.getMinReadIndex();
+    uint64_t nextIndex = minReadIndex;
+    for (uint32_t offset = this->windowBits; offset > 0; --offset) {
+        if (entry.window.isReadDone(minReadIndex + offset - 1)) {
+            nextIndex = minReadIndex + offset;
+            break;
+        }
+    }
+    // Nothing was read
+    if (nextIndex == 0) {
+        return;
+    }
+
+    // The slot of the sender, an empty slot or the oldest mark
+    Mark* mark = nullptr;
+    for (uint32_t probe = 0; probe < MARK_PROBES; ++probe) {
+        Mark& slot = this->marks[(entry.hash + probe) & this->markMask];
+        if (slot.nextIndex == 0 || slot.hash == entry.hash) {
+            mark = &slot;
+            break;
+        }
+        if (mark == nullptr || this->numberEvictions - slot.age > this->numberEvictions - mark->age) {
+            mark = &slot;
+        }
+    }
+    mark->hash = entry.hash;
+    mark->nextIndex = nextIndex;
+    mark->age = this->numberEvictions++;
+    mark->readBits = 0;
+    for (uint32_t bit = 0; bit < MARK_BITS && bit < nextIndex; ++bit) {
+        if (entry.window.isReadDone(nextIndex - 1 - bit)) {
+            mark->readBits |= 0x01ULL << bit;
+        }
+    }
+}
+
+// Starts the window of a new entry from the mark of the sender if it was evicted,
+// else around "index" so messages which come a bit late are accepted
+void SenderCounter::loadMark(uint16_t idx, uint64_t index) noexcept {
+    Entry& entry = this->entries[idx];
+    Mark* mark = findMark(entry.hash);
+    if (mark == nullptr) {
+        uint32_t halfWindow = this->windowBits / 2;
+        entry.window.reset(index >= halfWindow ? index - halfWindow : 0, 0);
+        return;
+    }
+
+    uint64_t minReadIndex = mark->nextIndex > MARK_BITS ? mark->nextIndex - MARK_BITS : 0;
+    entry.window.reset(minReadIndex, 0);
+    for (uint32_t bit = 0; bit < MARK_BITS && bit < mark->nextIndex; ++bit) {
+        if ((mark->readBits & (0x01ULL << bit)) != 0) {
+            entry.window.markReadDone(mark->nextIndex - 1 - bit);
+        }
+    }
+    // The window of the entry knows more from now on
+    mark->nextIndex = 0;
+}
+
+// Removes the entry from the index by backward shift deletion (no tombstones)
+void SenderCounter::removeSlot(uint16_t idx) noexcept {
+    uint32_t hole = this->entries[idx].hash & this->slotMask;
+    while (this->slots[hole] != idx) {
+        hole = (hole + 1) & this->slotMask;
+    }
+
+    for (uint32_t slot = (hole + 1) & this->slotMask; this->slots[slot] != NONE; slot = (slot + 1) & this->slotMask) {
+        uint32_t home = this->entries[this->slots[slot]].hash & this->slotMask;
+        // The entry can fill the hole if its home is not in ("hole", "slot"]
+        if (((slot - home) & this->slotMask) >= ((slot - hole) & this->slotMask)) {
+            this->slots[hole] = this->slots[slot];
+            hole = slot;
+        }
+    }
+    this->slots[hole] = NONE;
+}
+
+void SenderCounter::unlinkEntry(uint16_t idx) noexcept {
+    Entry& entry = this->entries[idx];
+    if (entry.prev != NONE) {
+        this->entries[entry.prev].next = entry.next;
+    } else if (this->head == idx) {
+        this->head = entry.next;
+    }
+    if (entry.next != NONE) {
+        this->entries[entry.next].prev = entry.prev;
+    } else if (this->tail == idx) {
+        this->tail = entry.prev;
+    }
+    entry.prev = NONE;
+    entry.next = NONE;
+}
+
+void SenderCounter::touchEntry(uint16_t idx) noexcept {
+    if (this->head == idx) {
+        return;
+    }
+    unlinkEntry(idx);
+    Entry& entry = this->entries[idx];
+    entry.next = this->head;
+    if (this->head != NONE) {
+        this->entries[this->head].prev = idx;
+    }
+    this->head = idx;
+    if (this->tail == NONE) {
+        this->tail = idx;
+    }
+}
@@ -0,0 +1,157 @@
+#include <new>
+#include <cstring>
+#include "cso_load/load_generator.h"
+#include "synchronization/clock.h"
+#ifdef ESP_PLATFORM
+#include <esp_system.h>
+#endif
+
+#define DEFAULT_MAX_IN_FLIGHT 32
+// Maximum messages of one "step", a late step does not send a burst
+#define MAX_STEP_MESSAGES 32
+
+std::unique_ptr<LoadGenerator> LoadGenerator::build(IConnector* connector, const char* recvName, const LoadMix& mix) {
+    return LoadGenerator::build(connector, recvName, mix, DEFAULT_MAX_IN_FLIGHT);
+}
+
+std::unique_ptr<LoadGenerator> LoadGenerator::build(IConnector* connector, const char* recvName, const LoadMix& mix, uint16_t maxInFlight) {
+    return std::unique_ptr<LoadGenerator>(new LoadGenerator(connector, recvName, mix, maxInFlight));
+}
+
+LoadGenerator::LoadGenerator(IConnector* connector, const char* recvName, const LoadMix& mix, uint16_t maxInFlight)
+    : connector(connector),
+      recvName(),
+      mix(mix),
+      content(nullptr),
+      startTime(TIMESTAMP_MICRO_SECS()),
+      nextTime(startTime),
+      seed((uint32_t)startTime | 1U),
+      spin(),
+      slots(nullptr),
+      maxInFlight(maxInFlight),
+      stats() {
+    if (this->connector == nullptr || this->maxInFlight == 0) {
+        throw "[cso_load/LoadGenerator(IConnector* connector, const char* recvName, const LoadMix& mix, uint16_t maxInFlight)]Connector is nullptr or in-flight slots are 0";
+    }
+    this->content.reset(new (std::nothrow) uint8_t[this->mix.maxSize > 0 ? this->mix.maxSize : 1]);
+    this->slots.reset(new (std::nothrow) Slot[this->maxInFlight]);
+    if (this->content == nullptr || this->slots == nullptr) {
+        throw "[cso_load/LoadGenerator(IConnector* connector, const char* recvName, const LoadMix& mix, uint16_t maxInFlight)]Not enough memory to create arrays";
+    }
+    strncpy(this->recvName, recvName, MAX_CONNECTION_NAME_LENGTH);
+    this->recvName[MAX_CONNECTION_NAME_LENGTH] = '\0';
+    for (uint16_t idx = 0; idx < this->mix.maxSize; ++idx) {
+        this->content[idx] = (uint8_t)idx;
+    }
+    for (uint16_t idx = 0; idx < this->maxInFlight; ++idx) {
+        this->slots[idx].generator = this;
+        this->slots[idx].sendTime = 0;
+        this->slots[idx].isUsed = false;
+    }
+}
+
+LoadGenerator::~LoadGenerator() noexcept {}
+
+uint64_t LoadGenerator::step() {
+    if (this->mix.messagesPerSecond == 0) {
+        return UINT64_MAX;
+    }
+    uint64_t interval = 1000000ULL / this->mix.messagesPerSecond;
+    uint64_t now = TIMESTAMP_MICRO_SECS();
+    for (uint16_t number = 0; number < MAX_STEP_MESSAGES && this->nextTime <= now; ++number) {
+        sendOne();
+        this->nextTime += interval;
+    }
+    // The messages which were missed are skipped, the rate is not made up later
+    if (this->nextTime <= now) {
+        this->nextTime = now + interval;
+    }
+    return this->nextTime;
+}
+
+LoadStats LoadGenerator::getStats() {
+    this->spin.lock();
+    LoadStats stats = this->stats;
+    this->spin.unlock();
+    stats.elapsed = TIMESTAMP_MICRO_SECS() - this->startTime;
+    stats.numberRetried = this->connector->getLaneStats(this->mix.priority).numberRetried;
+#ifdef ESP_PLATFORM
+    stats.freeHeap = esp_get_free_heap_size();
+#endif
+    return stats;
+}
+
+//========
+// PRIVATE
+//========
+uint32_t LoadGenerator::nextRandom() noexcept {
+    // xorshift32, only "step" uses it
+    this->seed ^= this->seed << 13;
+    this->seed ^= this->seed >> 17;
+    this->seed ^= this->seed << 5;
+    return this->seed;
+}
+
+void LoadGenerator::sendOne() {
+    uint16_t lenContent = this->mix.minSize + nextRandom() % (this->mix.maxSize - this->mix.minSize + 1U);
+    bool isEncrypted = nextRandom() % 100 < this->mix.encryptedPercent;
+    bool isReliable = nextRandom() % 100 < this->mix.reliablePercent;
+
+    if (!isReliable) {
+        Error::Code error = this->connector->sendMessage(this->recvName, this->content.get(), lenContent, isEncrypted, false);
+        this->spin.lock();
+        if (error == Error::Nil) {
+            this->stats.numberSent++;
+            this->stats.bytesSent += lenContent;
+        } else {
+            this->stats.numberRejected++;
+        }
+        this->spin.unlock();
+        return;
+    }
+
+    Slot* slot = nullptr;
+    this->spin.lock();
+    for (uint16_t idx = 0; idx < this->maxInFlight; ++idx) {
+        if (!this->slots[idx].isUsed) {
+            slot = &this->slots[idx];
+            slot->isUsed = true;
+            slot->sendTime = TIMESTAMP_MICRO_SECS();
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        this->stats.numberRejected++;
+        this->spin.unlock();
+        return;
+    }
+    this->stats.numberInFlight++;
+    this->spin.unlock();
+
+    // "complete" may run at once, so "spin" is not held here
+    Result<uint64_t> msgID = this->connector->sendMessageAsync(this->recvName, this->content.get(), lenContent, isEncrypted, this->mix.retry, &LoadGenerator::complete, slot, this->mix.priority);
+    this->spin.lock();
+    if (msgID.errorCode == Error::Nil) {
+        this->stats.numberSent++;
+        this->stats.bytesSent += lenContent;
+    } else {
+        this->stats.numberRejected++;
+    }
+    this->spin.unlock();
+}
+
+void LoadGenerator::complete(uint64_t, SendStatus::Code status, void* context) {
+    Slot* slot = static_cast<Slot*>(context);
+    LoadGenerator* generator = slot->generator;
+    uint64_t now = TIMESTAMP_MICRO_SECS();
+    generator->spin.lock();
+    if (status == SendStatus::Acked) {
+        generator->stats.numberAcked++;
+        generator->stats.addLatency(now - slot->sendTime);
+    } else if (status != SendStatus::QueueFull && status != SendStatus::Dropped) {
+        generator->stats.numberFailed++;
+    }
+    generator->stats.numberInFlight--;
+    slot->isUsed = false;
+    generator->spin.unlock();
+}
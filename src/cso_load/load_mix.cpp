@@ -0,0 +1,20 @@
+#include "cso_load/load_mix.h"
+
+#define DEFAULT_MESSAGES_PER_SECOND 10
+#define DEFAULT_MIN_SIZE 16
+#define DEFAULT_MAX_SIZE 128
+#define DEFAULT_ENCRYPTED_PERCENT 50
+#define DEFAULT_RELIABLE_PERCENT 50
+#define DEFAULT_RETRY 3
+
+LoadMix::LoadMix() noexcept
+    : LoadMix(DEFAULT_MESSAGES_PER_SECOND, DEFAULT_MIN_SIZE, DEFAULT_MAX_SIZE, DEFAULT_ENCRYPTED_PERCENT, DEFAULT_RELIABLE_PERCENT) {}
+
+LoadMix::LoadMix(uint32_t messagesPerSecond, uint16_t minSize, uint16_t maxSize, uint8_t encryptedPercent, uint8_t reliablePercent) noexcept
+    : messagesPerSecond(messagesPerSecond),
+      minSize(minSize),
+      maxSize(maxSize >= minSize ? maxSize : minSize),
+      encryptedPercent(encryptedPercent <= 100 ? encryptedPercent : 100),
+      reliablePercent(reliablePercent <= 100 ? reliablePercent : 100),
+      retry(DEFAULT_RETRY),
+      priority(Priority::Normal) {}
@@ -0,0 +1,80 @@
+#include "cso_load/load_stats.h"
+
+LoadStats::LoadStats() noexcept
+    : elapsed(0),
+      numberSent(0),
+      bytesSent(0),
+      numberRejected(0),
+      numberAcked(0),
+      numberFailed(0),
+      numberInFlight(0),
+      numberRetried(0),
+      freeHeap(0),
+      latencyBuckets(),
+      totalLatency(0),
+      maxLatency(0) {}
+
+void LoadStats::addLatency(uint64_t latency) noexcept {
+    uint64_t latencyMs = latency / 1000;
+    uint8_t bucket = 0;
+    while (latencyMs > 0 && bucket < NUMBER_ACK_LATENCY_BUCKETS - 1) {
+        latencyMs >>= 1;
+        bucket++;
+    }
+    this->latencyBuckets[bucket]++;
+    this->totalLatency += latency;
+    if (latency > this->maxLatency) {
+        this->maxLatency = latency;
+    }
+}
+
+uint64_t LoadStats::getPercentile(uint8_t percent) const noexcept {
+    uint64_t total = 0;
+    for (uint8_t idx = 0; idx < NUMBER_ACK_LATENCY_BUCKETS; ++idx) {
+        total += this->latencyBuckets[idx];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (total * percent + 99) / 100;
+    uint64_t count = 0;
+    for (uint8_t idx = 0; idx < NUMBER_ACK_LATENCY_BUCKETS - 1; ++idx) {
+        count += this->latencyBuckets[idx];
+        if (count >= rank) {
+            return (1ULL << idx) * 1000ULL;
+        }
+    }
+    // The last bucket has no upper bound
+    return this->maxLatency;
+}
+
+uint32_t LoadStats::getThroughput() const noexcept {
+    if (this->elapsed == 0) {
+        return 0;
+    }
+    return (uint32_t)(this->numberSent * 1000000ULL / this->elapsed);
+}
+
+void LoadStats::merge(const LoadStats& other) noexcept {
+    if (other.elapsed > this->elapsed) {
+        this->elapsed = other.elapsed;
+    }
+    this->numberSent += other.numberSent;
+    this->bytesSent += other.bytesSent;
+    this->numberRejected += other.numberRejected;
+    this->numberAcked += other.numberAcked;
+    this->numberFailed += other.numberFailed;
+    this->numberInFlight += other.numberInFlight;
+    this->numberRetried += other.numberRetried;
+    if (this->freeHeap == 0 || (other.freeHeap != 0 && other.freeHeap < this->freeHeap)) {
+        this->freeHeap = other.freeHeap;
+    }
+    for (uint8_t idx = 0; idx < NUMBER_ACK_LATENCY_BUCKETS; ++idx) {
+        this->latencyBuckets[idx] += other.latencyBuckets[idx];
+    }
+    this->totalLatency += other.totalLatency;
+    if (other.maxLatency > this->maxLatency) {
+        this->maxLatency = other.maxLatency;
+    }
+}
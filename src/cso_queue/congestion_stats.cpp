@@ -0,0 +1,10 @@
+#include "cso_queue/congestion_stats.h"
+
+CongestionStats::CongestionStats() noexcept
+    : window(0),
+      maxWindow(0),
+      minWindow(0),
+      numberInFlight(0),
+      numberIncreases(0),
+      numberTimeouts(0),
+      numberDecreases(0) {}
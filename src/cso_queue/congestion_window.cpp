@@ -0,0 +1,77 @@
+#include "cso_queue/congestion_window.h"
+
+#define WINDOW_SCALE 256U
+#define DEFAULT_INITIAL_WINDOW 4
+#define DEFAULT_MIN_WINDOW 1
+
+std::unique_ptr<CongestionWindow> CongestionWindow::build(uint32_t maxWindow) {
+    uint32_t initialWindow = maxWindow < DEFAULT_INITIAL_WINDOW ? maxWindow : DEFAULT_INITIAL_WINDOW;
+    return CongestionWindow::build(initialWindow, DEFAULT_MIN_WINDOW, maxWindow);
+}
+
+std::unique_ptr<CongestionWindow> CongestionWindow::build(uint32_t initialWindow, uint32_t minWindow, uint32_t maxWindow) {
+    return std::unique_ptr<CongestionWindow>(new CongestionWindow(initialWindow, minWindow, maxWindow));
+}
+
+CongestionWindow::CongestionWindow(uint32_t initialWindow, uint32_t minWindow, uint32_t maxWindow)
+    : minWindow(minWindow),
+      maxWindow(maxWindow),
+      window(initialWindow * WINDOW_SCALE),
+      decreaseTime(0),
+      stats() {
+    if (minWindow == 0 || minWindow > initialWindow || initialWindow > maxWindow || maxWindow > UINT32_MAX / WINDOW_SCALE) {
+        throw "[cso_queue/CongestionWindow(uint32_t initialWindow, uint32_t minWindow, uint32_t maxWindow)]Windows have to be 0 < min <= initial <= max";
+    }
+    this->stats.minWindow = initialWindow;
+    this->stats.maxWindow = initialWindow;
+    updateStats();
+}
+
+uint32_t CongestionWindow::getLimit() const noexcept {
+    return this->window / WINDOW_SCALE;
+}
+
+void CongestionWindow::onAck() noexcept {
+    if (this->window >= this->maxWindow * WINDOW_SCALE) {
+        return;
+    }
+    uint32_t step = WINDOW_SCALE * WINDOW_SCALE / this->window;
+    this->window += step > 0 ? step : 1;
+    if (this->window > this->maxWindow * WINDOW_SCALE) {
+        this->window = this->maxWindow * WINDOW_SCALE;
+    }
+    this->stats.numberIncreases++;
+    updateStats();
+}
+
+void CongestionWindow::onTimeout(uint64_t sendTime, uint64_t now) noexcept {
+    this->stats.numberTimeouts++;
+    if (sendTime <= this->decreaseTime) {
+        return;
+    }
+    this->window /= 2;
+    if (this->window < this->minWindow * WINDOW_SCALE) {
+        this->window = this->minWindow * WINDOW_SCALE;
+    }
+    this->decreaseTime = now;
+    this->stats.numberDecreases++;
+    updateStats();
+}
+
+CongestionStats CongestionWindow::getStats() const noexcept {
+    return this->stats;
+}
+
+//========
+// PRIVATE
+//========
+void CongestionWindow::updateStats() noexcept {
+    uint32_t limit = getLimit();
+    this->stats.window = limit;
+    if (limit > this->stats.maxWindow) {
+        this->stats.maxWindow = limit;
+    }
+    if (limit < this->stats.minWindow) {
+        this->stats.minWindow = limit;
+    }
+}
@@ -1,20 +1,35 @@
+#include <new>
 #include "cso_queue/item.h"
 
 ItemQueue::ItemQueue() noexcept
   : msgID(-1),
     msgTag(-1),
-    recvName(""),
-    content(),
+    recvName(),
+    content(nullptr),
+    lenContent(0),
     isEncrypted(false),
     isCached(false),
     isFirst(false),
     isLast(false),
     isRequest(false),
     isGroup(false),
+    priority(Priority::Normal),
     numberRetry(0),
-    timestamp(0) {}
+    timestamp(0),
+    enqueueTime(0),
+    deadline(0),
+    onComplete(nullptr),
+    context(nullptr),
+    inlineContent(nullptr),
+    lenInlineContent(0),
+    overflowContent() {}
 
-ItemQueue::ItemQueue(
+void ItemQueue::bind(uint8_t* inlineContent, uint16_t lenInlineContent) noexcept {
+    this->inlineContent = inlineContent;
+    this->lenInlineContent = lenInlineContent;
+}
+
+Error::Code ItemQueue::assign(
     uint64_t msgID,
     uint64_t msgTag,
     const char* recvName,
@@ -26,67 +41,52 @@ ItemQueue::ItemQueue(
     bool isLast,
     bool isRequest,
     bool isGroup,
+    Priority::Code priority,
     uint32_t numberRetry,
-    uint64_t timestamp
-) noexcept 
-  : msgID(msgID),
-    msgTag(msgTag),
-    recvName(recvName),
-    content(content, lenContent),
-    isEncrypted(isEncrypted),
-    isCached(isCached),
-    isFirst(isFirst),
-    isLast(isLast),
-    isRequest(isRequest),
-    isGroup(isGroup),
-    numberRetry(numberRetry),
-    timestamp(timestamp) {}
+    uint64_t enqueueTime,
+    uint64_t deadline
+) noexcept {
+    size_t lenName = strlen(recvName);
+    if (lenName == 0 || lenName > MAX_CONNECTION_NAME_LENGTH) {
+        return Error::Message_InvalidConnectionName;
+    }
 
-ItemQueue::ItemQueue(ItemQueue&& other) noexcept
-  : msgID(other.msgID),
-    msgTag(other.msgTag),
-    recvName(std::move(other.recvName)),
-    content(std::move(other.content)),
-    isEncrypted(other.isEncrypted),
-    isCached(other.isCached),
-    isFirst(other.isFirst),
-    isLast(other.isLast),
-    isRequest(other.isRequest),
-    isGroup(other.isGroup),
-    numberRetry(other.numberRetry),
-    timestamp(other.timestamp) {}
+    // Large content goes to the overflow path
+    if (lenContent <= this->lenInlineContent) {
+        this->content = this->inlineContent;
+    } else {
+        this->overflowContent.buffer.reset(new (std::nothrow) uint8_t[lenContent]);
+        if (this->overflowContent.buffer == nullptr) {
+            return Error::NotEnoughMemory;
+        }
+        this->overflowContent.length = lenContent;
+        this->content = this->overflowContent.buffer.get();
+    }
+    if (lenContent > 0) {
+        memcpy(this->content, content, lenContent);
+    }
+    memcpy(this->recvName, recvName, lenName + 1);
 
-ItemQueue& ItemQueue::operator=(ItemQueue&& other) noexcept {
-    this->msgID = other.msgID;
-    this->msgTag = other.msgTag;
-    std::swap(this->recvName, other.recvName);
-    std::swap(this->content, other.content);
-    this->isEncrypted = other.isEncrypted;
-    this->isCached = other.isCached;
-    this->isFirst = other.isFirst;
-    this->isLast = other.isLast;
-    this->isRequest = other.isRequest;
-    this->isGroup = other.isGroup;
-    this->numberRetry = other.numberRetry;
-    this->timestamp = other.timestamp;
-    return *this;
+    this->msgID = msgID;
+    this->msgTag = msgTag;
+    this->lenContent = lenContent;
+    this->isEncrypted = isEncrypted;
+    this->isCached = isCached;
+    this->isFirst = isFirst;
+    this->isLast = isLast;
+    this->isRequest = isRequest;
+    this->isGroup = isGroup;
+    this->priority = priority;
+    this->numberRetry = numberRetry;
+    this->timestamp = 0;
+    this->enqueueTime = enqueueTime;
+    this->deadline = deadline;
+    return Error::Nil;
 }
 
-Error::Code ItemQueue::copy(const ItemQueue& other) noexcept {
-    this->msgID = other.msgID;
-    this->msgTag = other.msgTag;
-    this->recvName = other.recvName;
-    auto errorCode = this->content.copy(other.content);
-    if (errorCode != Error::Nil) {
-        return errorCode;
-    }
-    this->isEncrypted = other.isEncrypted;
-    this->isCached = other.isCached;
-    this->isFirst = other.isFirst;
-    this->isLast = other.isLast;
-    this->isRequest = other.isRequest;
-    this->isGroup = other.isGroup;
-    this->numberRetry = other.numberRetry;
-    this->timestamp = other.timestamp;
-    return Error::Nil;
-}
\ No newline at end of file
+void ItemQueue::release() noexcept {
+    this->overflowContent.buffer.reset();
+    this->overflowContent.length = 0;
+    this->content = nullptr;
+    this->lenContent = 0;
+}
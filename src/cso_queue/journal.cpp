@@ -0,0 +1,311 @@
+#include <new>
+#include <unistd.h>
+#include "synchronization/clock.h"
+#include "cso_queue/journal.h"
+#include "cso_queue/interface.h"
+
+#define DEFAULT_BATCH_CAPACITY 1024
+#define DEFAULT_BATCH_INTERVAL 100 // (milli seconds)
+#define DEFAULT_MAX_FILE_SIZE 65536
+
+// Record: type (1) | msgID (8) | lenPayload (2) | lenContent (2) | payload | content
+#define LENGTH_RECORD_HEADER 13
+// Payload of "RECORD_PUSH": msgTag (8) | flags (1) | priority (1) | numberRetry (4) | ttl (4) | lenName (1) | name
+#define LENGTH_PUSH_PAYLOAD 19
+#define RECORD_PUSH 0x01U
+#define RECORD_CLEAR 0x02U
+
+std::shared_ptr<Journal> Journal::build(const char* path) {
+    return std::shared_ptr<Journal>(new Journal(path, DEFAULT_BATCH_CAPACITY, DEFAULT_BATCH_INTERVAL, DEFAULT_MAX_FILE_SIZE));
+}
+
+// "batchInterval" (milli seconds) is the maximum age of a batch before it is written.
+// "maxFileSize" (bytes) is the size which the file is compacted at, 0 if it is never compacted.
+std::shared_ptr<Journal> Journal::build(const char* path, uint32_t batchCapacity, uint32_t batchInterval, uint32_t maxFileSize) {
+    return std::shared_ptr<Journal>(new Journal(path, batchCapacity, batchInterval, maxFileSize));
+}
+
+Journal::Journal(const char* path, uint32_t batchCapacity, uint32_t batchInterval, uint32_t maxFileSize)
+    : mutex(),
+      path(path),
+      file(nullptr),
+      batch(nullptr),
+      lenBatch(0),
+      batchCapacity(batchCapacity),
+      batchInterval(batchInterval),
+      batchTime(0),
+      maxFileSize(maxFileSize),
+      fileSize(0),
+      numberLive(0),
+      stats() {
+    this->batch = new (std::nothrow) uint8_t[this->batchCapacity];
+    if (this->batch == nullptr) {
+        throw "[cso_queue/Journal(const char* path, uint32_t batchCapacity, uint32_t batchInterval, uint32_t maxFileSize)]Not enough memory to create array";
+    }
+}
+
+Journal::~Journal() noexcept {
+    sync(true);
+    if (this->file != nullptr) {
+        fclose(this->file);
+    }
+    delete[] this->batch;
+}
+
+Error::Code Journal::replay(IQueue* queue) noexcept {
+    FILE* input = fopen(this->path.c_str(), "rb");
+    if (input == nullptr) {
+        // Nothing was written before
+        return Error::Nil;
+    }
+
+    Error::Code errorCode = Error::Nil;
+    uint8_t header[LENGTH_RECORD_HEADER];
+    uint8_t payload[LENGTH_PUSH_PAYLOAD + MAX_CONNECTION_NAME_LENGTH + 1];
+    // A broken record at the tail (reset while writing) ends the replay
+    while (fread(header, 1, LENGTH_RECORD_HEADER, input) == LENGTH_RECORD_HEADER) {
+        uint64_t msgID;
+        uint16_t lenPayload;
+        uint16_t lenContent;
+        memcpy(&msgID, header + 1, sizeof(uint64_t));
+        memcpy(&lenPayload, header + 9, sizeof(uint16_t));
+        memcpy(&lenContent, header + 11, sizeof(uint16_t));
+
+        if (header[0] == RECORD_CLEAR) {
+            queue->clearMessage(msgID);
+            continue;
+        }
+        if (header[0] != RECORD_PUSH || lenPayload < LENGTH_PUSH_PAYLOAD || lenPayload > sizeof(payload) - 1) {
+            break;
+        }
+        if (fread(payload, 1, lenPayload, input) != lenPayload) {
+            break;
+        }
+        std::unique_ptr<uint8_t[]> content(new (std::nothrow) uint8_t[lenContent]);
+        if (content == nullptr) {
+            errorCode = Error::NotEnoughMemory;
+            break;
+        }
+        if (fread(content.get(), 1, lenContent, input) != lenContent) {
+            break;
+        }
+
+        uint64_t msgTag;
+        uint32_t numberRetry;
+        uint32_t ttl;
+        uint8_t flags = payload[8];
+        memcpy(&msgTag, payload, sizeof(uint64_t));
+        memcpy(&numberRetry, payload + 10, sizeof(uint32_t));
+        memcpy(&ttl, payload + 14, sizeof(uint32_t));
+        uint8_t lenName = payload[18];
+        if (LENGTH_PUSH_PAYLOAD + lenName != lenPayload) {
+            break;
+        }
+        payload[lenPayload] = '\0';
+
+        // A message can be appended twice if the journal was compacted while it was pushed
+        queue->clearMessage(msgID);
+        if (!queue->takeIndex()) {
+            continue;
+        }
+        queue->pushMessage(
+            msgID,
+            msgTag,
+            (const char*)(payload + LENGTH_PUSH_PAYLOAD),
+            content.get(),
+            lenContent,
+            (flags & 0x01U) != 0,
+            (flags & 0x02U) != 0,
+            (flags & 0x04U) != 0,
+            (flags & 0x08U) != 0,
+            (flags & 0x10U) != 0,
+            (flags & 0x20U) != 0,
+            (Priority::Code)payload[9],
+            numberRetry,
+            ttl,
+            nullptr,
+            nullptr
+        );
+    }
+    fclose(input);
+    return errorCode;
+}
+
+Error::Code Journal::reset() noexcept {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->file != nullptr) {
+        fclose(this->file);
+        this->file = nullptr;
+    }
+    this->lenBatch = 0;
+    this->fileSize = 0;
+    this->numberLive = 0;
+
+    // Truncate file
+    FILE* output = fopen(this->path.c_str(), "wb");
+    if (output == nullptr) {
+        return Error::CSOQueue_JournalFailed;
+    }
+    fclose(output);
+    return Error::Nil;
+}
+
+void Journal::appendPush(const ItemQueue& item, uint32_t ttl) noexcept {
+    uint64_t start = TIMESTAMP_MICRO_SECS();
+    uint8_t lenName = strlen(item.recvName);
+    uint8_t payload[LENGTH_PUSH_PAYLOAD + MAX_CONNECTION_NAME_LENGTH];
+    memcpy(payload, &item.msgTag, sizeof(uint64_t));
+    payload[8] = (item.isEncrypted ? 0x01U : 0) |
+                 (item.isCached ? 0x02U : 0) |
+                 (item.isFirst ? 0x04U : 0) |
+                 (item.isLast ? 0x08U : 0) |
+                 (item.isRequest ? 0x10U : 0) |
+                 (item.isGroup ? 0x20U : 0);
+    payload[9] = item.priority;
+    memcpy(payload + 10, &item.numberRetry, sizeof(uint32_t));
+    memcpy(payload + 14, &ttl, sizeof(uint32_t));
+    payload[18] = lenName;
+    memcpy(payload + LENGTH_PUSH_PAYLOAD, item.recvName, lenName);
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    append(RECORD_PUSH, item.msgID, payload, LENGTH_PUSH_PAYLOAD + lenName, item.content, item.lenContent);
+    this->numberLive++;
+
+    uint64_t elapsed = TIMESTAMP_MICRO_SECS() - start;
+    this->stats.numberMessages++;
+    this->stats.totalEnqueueTime += elapsed;
+    if (elapsed > this->stats.maxEnqueueTime) {
+        this->stats.maxEnqueueTime = elapsed;
+    }
+}
+
+void Journal::appendClear(uint64_t msgID) noexcept {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    append(RECORD_CLEAR, msgID, nullptr, 0, nullptr, 0);
+    if (this->numberLive > 0) {
+        this->numberLive--;
+    }
+}
+
+Error::Code Journal::sync(bool force) noexcept {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    // Every message was cleared, the records are useless
+    if (this->numberLive == 0 && (this->fileSize > 0 || this->lenBatch > 0)) {
+        if (this->file != nullptr) {
+            fclose(this->file);
+            this->file = nullptr;
+        }
+        this->lenBatch = 0;
+        this->fileSize = 0;
+        FILE* output = fopen(this->path.c_str(), "wb");
+        if (output == nullptr) {
+            return Error::CSOQueue_JournalFailed;
+        }
+        fclose(output);
+        return Error::Nil;
+    }
+
+    if (this->lenBatch == 0) {
+        return Error::Nil;
+    }
+    if (force || (TIMESTAMP_MICRO_SECS() - this->batchTime) >= this->batchInterval * 1000ULL) {
+        return writeBatch();
+    }
+    return Error::Nil;
+}
+
+uint64_t Journal::nextSyncTime() noexcept {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->lenBatch == 0) {
+        return UINT64_MAX;
+    }
+    return this->batchTime + this->batchInterval * 1000ULL;
+}
+
+bool Journal::needCompact() noexcept {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->maxFileSize != 0 && this->fileSize > this->maxFileSize;
+}
+
+JournalStats Journal::getStats() noexcept {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->stats;
+}
+
+//========
+// PRIVATE
+//========
+// "mutex" has to be locked
+void Journal::append(uint8_t type, uint64_t msgID, const uint8_t* payload, uint16_t lenPayload, const uint8_t* content, uint16_t lenContent) noexcept {
+    uint8_t header[LENGTH_RECORD_HEADER];
+    header[0] = type;
+    memcpy(header + 1, &msgID, sizeof(uint64_t));
+    memcpy(header + 9, &lenPayload, sizeof(uint16_t));
+    memcpy(header + 11, &lenContent, sizeof(uint16_t));
+
+    uint32_t lenRecord = LENGTH_RECORD_HEADER + lenPayload + lenContent;
+    if (this->lenBatch + lenRecord > this->batchCapacity) {
+        writeBatch();
+    }
+
+    // The record is larger than the batch, write it directly
+    if (lenRecord > this->batchCapacity) {
+        if (this->file == nullptr) {
+            this->file = fopen(this->path.c_str(), "ab");
+            if (this->file == nullptr) {
+                return;
+            }
+        }
+        fwrite(header, 1, LENGTH_RECORD_HEADER, this->file);
+        if (lenPayload > 0) {
+            fwrite(payload, 1, lenPayload, this->file);
+        }
+        if (lenContent > 0) {
+            fwrite(content, 1, lenContent, this->file);
+        }
+        fflush(this->file);
+        fsync(fileno(this->file));
+        this->fileSize += lenRecord;
+        this->stats.numberWrites++;
+        return;
+    }
+
+    if (this->lenBatch == 0) {
+        this->batchTime = TIMESTAMP_MICRO_SECS();
+    }
+    memcpy(this->batch + this->lenBatch, header, LENGTH_RECORD_HEADER);
+    this->lenBatch += LENGTH_RECORD_HEADER;
+    if (lenPayload > 0) {
+        memcpy(this->batch + this->lenBatch, payload, lenPayload);
+        this->lenBatch += lenPayload;
+    }
+    if (lenContent > 0) {
+        memcpy(this->batch + this->lenBatch, content, lenContent);
+        this->lenBatch += lenContent;
+    }
+}
+
+// "mutex" has to be locked
+Error::Code Journal::writeBatch() noexcept {
+    if (this->lenBatch == 0) {
+        return Error::Nil;
+    }
+    if (this->file == nullptr) {
+        this->file = fopen(this->path.c_str(), "ab");
+        if (this->file == nullptr) {
+            return Error::CSOQueue_JournalFailed;
+        }
+    }
+
+    uint32_t lenBatch = this->lenBatch;
+    size_t written = fwrite(this->batch, 1, lenBatch, this->file);
+    fflush(this->file);
+    fsync(fileno(this->file));
+    this->fileSize += written;
+    this->lenBatch = 0;
+    this->stats.numberWrites++;
+    if (written != lenBatch) {
+        return Error::CSOQueue_JournalFailed;
+    }
+    return Error::Nil;
+}
@@ -0,0 +1,7 @@
+#include "cso_queue/journal_stats.h"
+
+JournalStats::JournalStats() noexcept
+    : numberMessages(0),
+      numberWrites(0),
+      totalEnqueueTime(0),
+      maxEnqueueTime(0) {}
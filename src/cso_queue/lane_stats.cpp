@@ -0,0 +1,9 @@
+#include "cso_queue/lane_stats.h"
+
+LaneStats::LaneStats() noexcept
+    : depth(0),
+      numberSent(0),
+      numberRetried(0),
+      totalWaitTime(0),
+      maxWaitTime(0),
+      numberExpired(0) {}
@@ -1,21 +1,107 @@
-#include <esp_timer.h>
+#include <new>
+#include "synchronization/clock.h"
 #include "cso_queue/queue.h"
 
+#define RETRY_INTERVAL 3000000ULL // (micro seconds)
+#define DEFAULT_LENGTH_INLINE_CONTENT 64
+
+// "High" has strict priority, "Normal" and "Bulk" share the rest by 4:1
+static const uint8_t DEFAULT_LANE_WEIGHTS[NUMBER_PRIORITIES] = { 0, 4, 1 };
+
 std::unique_ptr<IQueue> Queue::build(uint32_t capacity) {
-    return std::unique_ptr<IQueue>(new Queue(capacity));
+    return Queue::build(capacity, capacity, DEFAULT_LENGTH_INLINE_CONTENT, DEFAULT_LANE_WEIGHTS, nullptr);
+}
+
+std::unique_ptr<IQueue> Queue::build(uint32_t capacity, uint32_t maxInFlight) {
+    return Queue::build(capacity, maxInFlight, DEFAULT_LENGTH_INLINE_CONTENT, DEFAULT_LANE_WEIGHTS, nullptr);
+}
+
+std::unique_ptr<IQueue> Queue::build(uint32_t capacity, uint32_t maxInFlight, uint16_t lenInlineContent) {
+    return Queue::build(capacity, maxInFlight, lenInlineContent, DEFAULT_LANE_WEIGHTS, nullptr);
+}
+
+// A lane with weight 0 has strict priority over lower lanes.
+// Otherwise its weight is the number of messages it can send
+// before lower lanes get their turn.
+std::unique_ptr<IQueue> Queue::build(uint32_t capacity, uint32_t maxInFlight, uint16_t lenInlineContent, const uint8_t laneWeights[NUMBER_PRIORITIES]) {
+    return Queue::build(capacity, maxInFlight, lenInlineContent, laneWeights, nullptr);
+}
+
+// Messages in "journal" which were not acknowledged are pushed into the queue again
+std::unique_ptr<IQueue> Queue::build(uint32_t capacity, uint32_t maxInFlight, uint16_t lenInlineContent, const uint8_t laneWeights[NUMBER_PRIORITIES], std::shared_ptr<Journal> journal) {
+    return Queue::build(capacity, maxInFlight, lenInlineContent, laneWeights, journal, nullptr);
+}
+
+// Messages in flight are limited by "congestionWindow" instead of a fixed number
+std::unique_ptr<IQueue> Queue::build(uint32_t capacity, std::unique_ptr<CongestionWindow> congestionWindow) {
+    return Queue::build(capacity, capacity, DEFAULT_LENGTH_INLINE_CONTENT, DEFAULT_LANE_WEIGHTS, nullptr, std::move(congestionWindow));
+}
+
+// "maxInFlight" is ignored if "congestionWindow" is not nullptr
+std::unique_ptr<IQueue> Queue::build(uint32_t capacity, uint32_t maxInFlight, uint16_t lenInlineContent, const uint8_t laneWeights[NUMBER_PRIORITIES], std::shared_ptr<Journal> journal, std::unique_ptr<CongestionWindow> congestionWindow) {
+    return std::unique_ptr<IQueue>(new Queue(capacity, maxInFlight, lenInlineContent, laneWeights, journal, congestionWindow));
 }
 
-Queue::Queue(uint32_t cap) 
+Queue::Queue(uint32_t cap, uint32_t maxInFlight, uint16_t lenInlineContent, const uint8_t laneWeights[NUMBER_PRIORITIES], std::shared_ptr<Journal>& journal, std::unique_ptr<CongestionWindow>& congestionWindow) 
     : capacity(cap),
-      length(0) {
-    this->items = new (std::nothrow) std::unique_ptr<ItemQueue>[this->capacity];
-    if (this->items == nullptr) {
-        throw "[cso_queue/Queue(uint32_t cap)]Not enough memory to create array";
+      maxInFlight(maxInFlight),
+      numberInFlight(0),
+      length(0),
+      items(nullptr),
+      contents(nullptr),
+      usedItems(nullptr),
+      spin(),
+      freeIndexes(nullptr),
+      numberFreeIndexes(cap),
+      laneStats(),
+      journal(nullptr),
+      congestionWindow(nullptr) {
+    this->congestionWindow.swap(congestionWindow);
+    memcpy(this->laneWeights, laneWeights, NUMBER_PRIORITIES);
+    memcpy(this->laneCredits, laneWeights, NUMBER_PRIORITIES);
+
+    this->items = new (std::nothrow) ItemQueue[this->capacity];
+    this->contents = new (std::nothrow) uint8_t[this->capacity * lenInlineContent];
+    this->usedItems = new (std::nothrow) std::atomic<bool>[this->capacity];
+    this->freeIndexes = new (std::nothrow) uint32_t[this->capacity];
+    if (this->items == nullptr || 
+        this->contents == nullptr || 
+        this->usedItems == nullptr || 
+        this->freeIndexes == nullptr) {
+        delete[] this->items;
+        delete[] this->contents;
+        delete[] this->usedItems;
+        delete[] this->freeIndexes;
+        throw "[cso_queue/Queue(uint32_t cap, uint32_t maxInFlight, uint16_t lenInlineContent, const uint8_t laneWeights[], std::shared_ptr<Journal>& journal, std::unique_ptr<CongestionWindow>& congestionWindow)]Not enough memory to create array";
+    }
+
+    for (uint32_t idx = 0; idx < this->capacity; ++idx) {
+        this->items[idx].bind(this->contents + idx * lenInlineContent, lenInlineContent);
+        this->usedItems[idx].store(false);
+        // Lower indexes are popped first
+        this->freeIndexes[idx] = this->capacity - idx - 1;
+    }
+
+    if (journal == nullptr) {
+        return;
     }
+    // "this->journal" is still empty, replayed messages are not appended again
+    if (journal->replay(this) != Error::Nil) {
+        delete[] this->items;
+        delete[] this->contents;
+        delete[] this->usedItems;
+        delete[] this->freeIndexes;
+        throw "[cso_queue/Queue(uint32_t cap, uint32_t maxInFlight, uint16_t lenInlineContent, const uint8_t laneWeights[], std::shared_ptr<Journal>& journal, std::unique_ptr<CongestionWindow>& congestionWindow)]Replay journal failed";
+    }
+    this->journal.swap(journal);
+    compactJournal();
 }
 
 Queue::~Queue() {
     delete[] this->items;
+    delete[] this->contents;
+    delete[] this->usedItems;
+    delete[] this->freeIndexes;
 }
 
 // Method can invoke on many threads
@@ -28,42 +114,335 @@ bool Queue::takeIndex() noexcept {
     return false;
 }
 
-void Queue::pushMessage(ItemQueue* item) noexcept {
-    for (uint32_t idx = 0; idx < this->capacity; ++idx) {
-        if (this->items[idx] == nullptr) {
-            this->items[idx].reset(item);
-            break;
-        }
+bool Queue::takeIndexes(uint32_t number) noexcept {
+    if (this->length.fetch_add(number) + number <= this->capacity) {
+        return true;
     }
+    this->length.fetch_sub(number);
+    return false;
+}
+
+Error::Code Queue::pushMessage(
+    uint64_t msgID,
+    uint64_t msgTag,
+    const char* recvName,
+    uint8_t* content,
+    uint16_t lenContent,
+    bool isEncrypted,
+    bool isCached,
+    bool isFirst,
+    bool isLast,
+    bool isRequest,
+    bool isGroup,
+    Priority::Code priority,
+    uint32_t numberRetry,
+    uint32_t ttl,
+    SendCallback onComplete,
+    void* context
+) noexcept {
+    if (priority >= NUMBER_PRIORITIES) {
+        priority = Priority::Bulk;
+    }
+
+    // "takeIndex" guarantees that there is an unused item
+    uint32_t idx = popFreeIndex();
+    uint64_t now = TIMESTAMP_MICRO_SECS();
+    Error::Code errorCode = this->items[idx].assign(
+        msgID,
+        msgTag,
+        recvName,
+        content,
+        lenContent,
+        isEncrypted,
+        isCached,
+        isFirst,
+        isLast,
+        isRequest,
+        isGroup,
+        priority,
+        numberRetry,
+        now,
+        ttl == 0 ? 0 : now + ttl * 1000ULL
+    );
+    if (errorCode != Error::Nil) {
+        pushFreeIndex(idx);
+        this->length.fetch_sub(1);
+        return errorCode;
+    }
+    this->items[idx].onComplete = onComplete;
+    this->items[idx].context = context;
+
+    this->spin.lock();
+    this->laneStats[priority].depth++;
+    this->spin.unlock();
+    this->usedItems[idx].store(true);
+    if (this->journal != nullptr) {
+        this->journal->appendPush(this->items[idx], ttl);
+    }
+    return Error::Nil;
 }
 
 ItemQueueRef Queue::nextMessage() noexcept {
-    ItemQueue* nextItem = nullptr;
-    uint64_t now = esp_timer_get_time() / 1000000ULL; // (seconds)
+    if (this->journal != nullptr) {
+        if (this->journal->needCompact()) {
+            compactJournal();
+        }
+        this->journal->sync(false);
+    }
+
+    // The due message with the earliest deadline of every lane
+    ItemQueue* candidates[NUMBER_PRIORITIES] = { nullptr };
+    uint32_t maxInFlight = getInFlightLimit();
+    uint64_t now = TIMESTAMP_MICRO_SECS(); // (micro seconds)
     for (uint32_t idx = 0; idx < this->capacity; ++idx) {
-        if (this->items[idx] == nullptr) {
+        if (!this->usedItems[idx].load()) {
            continue;
         }
-        if (nextItem == nullptr && (now - this->items[idx]->timestamp) >= 3) {
-            nextItem = this->items[idx].get();
-            nextItem->timestamp = now;
-            nextItem->numberRetry--;
+        ItemQueue* item = &this->items[idx];
+        // The message is useless, drop it without sending
+        if (item->deadline != 0 && now >= item->deadline) {
+            this->spin.lock();
+            this->laneStats[item->priority].numberExpired++;
+            this->spin.unlock();
+            removeItem(idx, SendStatus::Expired);
+            continue;
+        }
+
+        // "timestamp" is 0 until the message is sent the first time
+        if (item->timestamp != 0 && (now - item->timestamp) < RETRY_INTERVAL) {
+            continue;
+        }
+
+        // The last sending got no response in time
+        if (item->numberRetry == 0) {
+            if (this->congestionWindow != nullptr) {
+                this->spin.lock();
+                this->congestionWindow->onTimeout(item->timestamp, now);
+                this->spin.unlock();
+            }
+            removeItem(idx, SendStatus::Exhausted);
+            continue;
+        }
+
+        // "High" messages are not held back by the in-flight limit
+        if (item->timestamp == 0 && 
+            item->priority != Priority::High && 
+            this->numberInFlight >= maxInFlight) {
+            continue;
         }
-        if (this->items[idx]->numberRetry == 0) {
-            this->items[idx].reset();
-            this->length.fetch_sub(1);
+
+        ItemQueue*& candidate = candidates[item->priority];
+        if (candidate == nullptr || isEarlier(*item, *candidate)) {
+            candidate = item;
         }
     }
+
+    ItemQueue* nextItem = scheduleLanes(candidates);
+    if (nextItem == nullptr) {
+        return ItemQueueRef(nullptr);
+    }
+
+    if (nextItem->timestamp == 0) {
+        this->numberInFlight++;
+        uint64_t waitTime = now - nextItem->enqueueTime;
+        this->spin.lock();
+        LaneStats& stats = this->laneStats[nextItem->priority];
+        stats.numberSent++;
+        stats.totalWaitTime += waitTime;
+        if (waitTime > stats.maxWaitTime) {
+            stats.maxWaitTime = waitTime;
+        }
+        this->spin.unlock();
+    } else {
+        // The message is sent again, its last sending got no response in time
+        this->spin.lock();
+        this->laneStats[nextItem->priority].numberRetried++;
+        if (this->congestionWindow != nullptr) {
+            this->congestionWindow->onTimeout(nextItem->timestamp, now);
+        }
+        this->spin.unlock();
+    }
+    nextItem->timestamp = now;
+    nextItem->numberRetry--;
     return ItemQueueRef(nextItem);
 }
 
+uint64_t Queue::nextDueTime() noexcept {
+    uint64_t dueTime = UINT64_MAX;
+    if (this->journal != nullptr) {
+        dueTime = this->journal->nextSyncTime();
+    }
+    uint32_t maxInFlight = getInFlightLimit();
+
+    for (uint32_t idx = 0; idx < this->capacity; ++idx) {
+        if (!this->usedItems[idx].load()) {
+           continue;
+        }
+        const ItemQueue& item = this->items[idx];
+        if (item.deadline != 0 && item.deadline < dueTime) {
+            dueTime = item.deadline;
+        }
+
+        uint64_t itemTime;
+        if (item.timestamp != 0) {
+            itemTime = item.timestamp + RETRY_INTERVAL;
+        } else if (item.priority == Priority::High || this->numberInFlight < maxInFlight) {
+            itemTime = item.enqueueTime;
+        } else {
+            // Waits for a response which frees the in-flight limit
+            continue;
+        }
+        if (itemTime < dueTime) {
+            dueTime = itemTime;
+        }
+    }
+    return dueTime;
+}
+
 void Queue::clearMessage(uint64_t msgID) noexcept {
-    if (msgID >= this->capacity) {
-        return;
+    for (uint32_t idx = 0; idx < this->capacity; ++idx) {
+        if (this->usedItems[idx].load() && this->items[idx].msgID == msgID) {
+            removeItem(idx, SendStatus::Acked);
+            return;
+        }
     }
-    if (this->items[msgID].get() == nullptr) {
-        return;
+}
+
+CongestionStats Queue::getCongestionStats() noexcept {
+    CongestionStats stats;
+    this->spin.lock();
+    if (this->congestionWindow != nullptr) {
+        stats = this->congestionWindow->getStats();
+    } else {
+        stats.window = this->maxInFlight;
+        stats.maxWindow = this->maxInFlight;
+        stats.minWindow = this->maxInFlight;
+    }
+    stats.numberInFlight = this->numberInFlight;
+    this->spin.unlock();
+    return stats;
+}
+
+LaneStats Queue::getLaneStats(Priority::Code priority) noexcept {
+    if (priority >= NUMBER_PRIORITIES) {
+        return LaneStats();
+    }
+    this->spin.lock();
+    LaneStats stats = this->laneStats[priority];
+    this->spin.unlock();
+    return stats;
+}
+
+//========
+// PRIVATE
+//========
+// Earliest deadline first, messages without deadline go last in pushing order
+bool Queue::isEarlier(const ItemQueue& item, const ItemQueue& other) noexcept {
+    if (item.deadline != other.deadline) {
+        if (item.deadline == 0) {
+            return false;
+        }
+        return other.deadline == 0 || item.deadline < other.deadline;
+    }
+    return item.enqueueTime < other.enqueueTime;
+}
+
+ItemQueue* Queue::scheduleLanes(ItemQueue* candidates[NUMBER_PRIORITIES]) noexcept {
+    ItemQueue* first = nullptr;
+    for (uint8_t lane = 0; lane < NUMBER_PRIORITIES; ++lane) {
+        if (candidates[lane] == nullptr) {
+            continue;
+        }
+        if (this->laneWeights[lane] == 0) {
+            return candidates[lane];
+        }
+        if (this->laneCredits[lane] > 0) {
+            this->laneCredits[lane]--;
+            return candidates[lane];
+        }
+        if (first == nullptr) {
+            first = candidates[lane];
+        }
+    }
+
+    // Every waiting lane has used its credits, start a new round
+    if (first != nullptr) {
+        memcpy(this->laneCredits, this->laneWeights, NUMBER_PRIORITIES);
+        this->laneCredits[first->priority]--;
+    }
+    return first;
+}
+
+uint32_t Queue::popFreeIndex() noexcept {
+    this->spin.lock();
+    uint32_t idx = this->freeIndexes[--this->numberFreeIndexes];
+    this->spin.unlock();
+    return idx;
+}
+
+void Queue::pushFreeIndex(uint32_t idx) noexcept {
+    this->spin.lock();
+    this->freeIndexes[this->numberFreeIndexes++] = idx;
+    this->spin.unlock();
+}
+
+void Queue::removeItem(uint32_t idx, SendStatus::Code status) noexcept {
+    ItemQueue& item = this->items[idx];
+    // The item can be reused by "pushMessage" once its index is freed
+    uint64_t msgID = item.msgID;
+    SendCallback onComplete = item.onComplete;
+    void* context = item.context;
+    item.onComplete = nullptr;
+    item.context = nullptr;
+    if (item.timestamp != 0) {
+        this->numberInFlight--;
+        if (status == SendStatus::Acked && this->congestionWindow != nullptr) {
+            this->spin.lock();
+            this->congestionWindow->onAck();
+            this->spin.unlock();
+        }
+    }
+    if (this->journal != nullptr) {
+        this->journal->appendClear(item.msgID);
     }
-    this->items[msgID].reset();
+    item.release();
+    this->usedItems[idx].store(false);
+
+    this->spin.lock();
+    this->laneStats[item.priority].depth--;
+    this->freeIndexes[this->numberFreeIndexes++] = idx;
+    this->spin.unlock();
     this->length.fetch_sub(1);
-}
\ No newline at end of file
+
+    if (onComplete != nullptr) {
+        onComplete(msgID, status, context);
+    }
+}
+
+// Rewrites the journal with messages in queue only
+void Queue::compactJournal() noexcept {
+    uint64_t now = TIMESTAMP_MICRO_SECS();
+    this->journal->reset();
+    for (uint32_t idx = 0; idx < this->capacity; ++idx) {
+        if (!this->usedItems[idx].load()) {
+            continue;
+        }
+        const ItemQueue& item = this->items[idx];
+        uint32_t ttl = 0;
+        if (item.deadline != 0) {
+            ttl = item.deadline > now ? (item.deadline - now + 999) / 1000 : 1;
+        }
+        this->journal->appendPush(item, ttl);
+    }
+    this->journal->sync(true);
+}
+
+uint32_t Queue::getInFlightLimit() noexcept {
+    if (this->congestionWindow == nullptr) {
+        return this->maxInFlight;
+    }
+    this->spin.lock();
+    uint32_t limit = this->congestionWindow->getLimit();
+    this->spin.unlock();
+    return limit;
+}
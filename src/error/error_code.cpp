@@ -92,6 +92,11 @@ void Error::getContentInternalTag(Error::Code code) noexcept {
         return;
     }
 
+    if (code == Error::CSOConnection_InvalidLength) {
+        strcpy(Error::content, "[CSO_Connection] Message is too long for a frame");
+        return;
+    }
+
     //==============
     // CSO_Connector
     //==============
@@ -104,6 +109,46 @@ void Error::getContentInternalTag(Error::Code code) noexcept {
         return;
     }
 
+    if (code == Error::CSOConnector_InvalidFragment) {
+        strcpy(Error::content, "[CSO_Connector] Fragment is invalid or its message is too large");
+        return;
+    }
+
+    if (code == Error::CSOConnector_ReassemblyFull) {
+        strcpy(Error::content, "[CSO_Connector] Too many large messages are being reassembled");
+        return;
+    }
+
+    if (code == Error::CSOConnector_CallTableFull) {
+        strcpy(Error::content, "[CSO_Connector] Too many calls are waiting for a response");
+        return;
+    }
+
+    if (code == Error::CSOConnector_InvalidCall) {
+        strcpy(Error::content, "[CSO_Connector] Request or response is too long for a call, or its timeout is 0");
+        return;
+    }
+
+    if (code == Error::CSOConnector_SubscriptionFull) {
+        strcpy(Error::content, "[CSO_Connector] Too many subscriptions");
+        return;
+    }
+
+    if (code == Error::CSOConnector_RateLimited) {
+        strcpy(Error::content, "[CSO_Connector] Message is over the rate limit");
+        return;
+    }
+
+    if (code == Error::CSOConnector_InboxFull) {
+        strcpy(Error::content, "[CSO_Connector] Inbox is full, the message is not acknowledged");
+        return;
+    }
+
+    if (code == Error::CSOConnector_PoolFull) {
+        strcpy(Error::content, "[CSO_Connector] Connector pool is full");
+        return;
+    }
+
     //========
     // Message
     //========
@@ -128,6 +173,14 @@ void Error::getContentInternalTag(Error::Code code) noexcept {
         return;
     }
 
+    //==========
+    // CSO_Queue
+    //==========
+    if (code == Error::CSOQueue_JournalFailed) {
+        strcpy(Error::content, "[CSO_Queue] Read or write journal failed");
+        return;
+    }
+
     //=============
     // Code invalid
     //=============
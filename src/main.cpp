@@ -5,13 +5,9 @@
 #include "cso_connector/connector.h"
 
 bool setupDone = false;
-TaskHandle_t loopReconnectTask;
+TaskHandle_t connectorTask;
 std::unique_ptr<IConnector> connector;
 
-void exec(void* pvParameters) {
-    connector->loopReconnect();
-}
-
 Error::Code callback(const char* sender, uint8_t* data, uint16_t lenData) {
     // Handle response message
     for (int i = 0; i < lenData; ++i) {
@@ -21,6 +17,11 @@ Error::Code callback(const char* sender, uint8_t* data, uint16_t lenData) {
     return Error::Nil;
 }
 
+void exec(void* pvParameters) {
+    // Connects, receives and sends on this task, it sleeps until there is work to do
+    connector->run(callback);
+}
+
 void setup() {
     Serial.begin(115200);
 
@@ -42,7 +43,7 @@ void setup() {
 
     // Check successfull allocation memory for "connector" object
     try {
-        connector = Connector::build(1024, Config::build(
+        connector = Connector::build(256, Config::build(
             "75d383f4-594a-11ea-8b79-0242ac11000200010000",
             "JhsNVLDPVO3fIRDmt+iP76AUjeZXkFl9MjJdD5hgp6tjiuU5fmEByGflKplb9aA+MLx8FjjumctJJ51jKPATiQ==",
             "trung3",
@@ -58,11 +59,11 @@ void setup() {
     // Assign task for core2
     xTaskCreatePinnedToCore(
         exec,                   /* Task function */
-        "Loop-Reconnect-Task",  /* name of task */
+        "Connector-Task",       /* name of task */
         30 * 1024,              /* Stack size of task */
         NULL,                   /* parameter of the task */
         1,                      /* priority of the task */
-        &loopReconnectTask,     /* Task handle to keep track of created task */
+        &connectorTask,         /* Task handle to keep track of created task */
         0                       /* pin task to core 0 */
     );
     setupDone = true;
@@ -78,8 +79,6 @@ void loop() {
         return;
     }
 
-    // connector->loopReconnect();
-    connector->listen(callback);
     byte data[3] = {65, 66, 67};
     Error::Code errorCode = connector->sendMessage("trung3", data, 3, false, false);
     if (errorCode != Error::Nil) {
@@ -88,5 +87,5 @@ void loop() {
         return;
     }
     Serial.println("Send message success");
-    vTaskDelay(50 / portTICK_PERIOD_MS);
+    vTaskDelay(1000 / portTICK_PERIOD_MS);
 }
\ No newline at end of file
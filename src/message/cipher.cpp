@@ -2,8 +2,6 @@
 #include "message/cipher.h"
 #include "message/define.h"
 
-#define MAX_CONNECTION_NAME_LENGTH 36
-
 Cipher::Cipher() noexcept
  : msgID(-1),
    msgTag(-1),
@@ -0,0 +1,61 @@
+#include <chrono>
+#include "synchronization/event.h"
+
+#ifdef ESP_PLATFORM
+
+Event::Event() 
+    : isNotified(false),
+      waiter(nullptr) {}
+
+Event::~Event() {}
+
+void Event::notify() noexcept {
+    if (this->isNotified.exchange(true)) {
+        return;
+    }
+    TaskHandle_t task = this->waiter.load();
+    if (task != nullptr) {
+        xTaskNotifyGive(task);
+    }
+}
+
+bool Event::wait(uint32_t timeout) noexcept {
+    // "waiter" is set before "isNotified" is checked,
+    // so a "notify" in between still gives the task notification
+    this->waiter.store(xTaskGetCurrentTaskHandle());
+    bool notified = this->isNotified.exchange(false);
+    if (!notified) {
+        notified = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout)) > 0;
+    }
+    this->waiter.store(nullptr);
+    this->isNotified.store(false);
+    // A notification which is given late is taken by the next "wait",
+    // that "wait" returns early, which is harmless
+    return notified;
+}
+
+#else
+
+Event::Event() 
+    : isNotified(false) {}
+
+Event::~Event() {}
+
+void Event::notify() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->isNotified.store(true);
+    }
+    this->condition.notify_one();
+}
+
+bool Event::wait(uint32_t timeout) noexcept {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    bool notified = this->condition.wait_for(lock, std::chrono::milliseconds(timeout), [this] {
+        return this->isNotified.load();
+    });
+    this->isNotified.store(false);
+    return notified;
+}
+
+#endif
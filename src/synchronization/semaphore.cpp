@@ -0,0 +1,57 @@
+#include <chrono>
+#include "synchronization/semaphore.h"
+
+#ifdef ESP_PLATFORM
+
+Semaphore::Semaphore(uint32_t maxCount) 
+    : handle(nullptr) {
+    this->handle = xSemaphoreCreateCounting(maxCount, 0);
+    if (this->handle == nullptr) {
+        throw "[synchronization/Semaphore(uint32_t maxCount)]Not enough memory to create semaphore";
+    }
+}
+
+Semaphore::~Semaphore() {
+    vSemaphoreDelete(this->handle);
+}
+
+void Semaphore::notify() noexcept {
+    // It fails if "maxCount" notifications wait already, which is harmless
+    xSemaphoreGive(this->handle);
+}
+
+bool Semaphore::wait(uint32_t timeout) noexcept {
+    return xSemaphoreTake(this->handle, pdMS_TO_TICKS(timeout)) == pdTRUE;
+}
+
+#else
+
+Semaphore::Semaphore(uint32_t maxCount) 
+    : count(0),
+      maxCount(maxCount) {}
+
+Semaphore::~Semaphore() {}
+
+void Semaphore::notify() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->count >= this->maxCount) {
+            return;
+        }
+        this->count++;
+    }
+    this->condition.notify_one();
+}
+
+bool Semaphore::wait(uint32_t timeout) noexcept {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    bool notified = this->condition.wait_for(lock, std::chrono::milliseconds(timeout), [this] {
+        return this->count > 0;
+    });
+    if (notified) {
+        this->count--;
+    }
+    return notified;
+}
+
+#endif
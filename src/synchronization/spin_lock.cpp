@@ -1,5 +1,7 @@
 #include "synchronization/spin_lock.h"
 
+#ifdef ESP_PLATFORM
+
 SpinLock::SpinLock() {
     vPortCPUInitializeMutex(&this->core);
 }
@@ -12,4 +14,22 @@ void SpinLock::lock() {
 
 void SpinLock::unlock() {
     vTaskExitCritical(&this->core);
-}
\ No newline at end of file
+}
+
+#else
+
+SpinLock::SpinLock() {
+    this->core.clear();
+}
+
+SpinLock::~SpinLock() {}
+
+void SpinLock::lock() {
+    while (this->core.test_and_set(std::memory_order_acquire)) {}
+}
+
+void SpinLock::unlock() {
+    this->core.clear(std::memory_order_release);
+}
+
+#endif
@@ -0,0 +1,107 @@
+// Throughput of "ConcurrencyQueue" against a ring guarded by "SpinLock",
+// which is how the queue worked before it became lock-free
+#include <atomic>
+#include "host_test.h"
+#include "synchronization/spin_lock.h"
+#include "synchronization/concurrency_queue.h"
+
+#define CAPACITY 256
+
+class SpinLockRing {
+private:
+    std::vector<uint32_t> buffer;
+    SpinLock spin;
+    uint32_t size;
+    uint32_t indexRead;
+    uint32_t indexWrite;
+
+public:
+    SpinLockRing(uint32_t capacity)
+        : buffer(capacity),
+          spin(),
+          size(0),
+          indexRead(0),
+          indexWrite(0) {}
+
+    bool push(uint32_t value) {
+        this->spin.lock();
+        if (this->size == this->buffer.size()) {
+            this->spin.unlock();
+            return false;
+        }
+        this->buffer[this->indexWrite] = value;
+        this->indexWrite = (this->indexWrite + 1) % this->buffer.size();
+        this->size++;
+        this->spin.unlock();
+        return true;
+    }
+
+    bool pop(uint32_t& value) {
+        this->spin.lock();
+        if (this->size == 0) {
+            this->spin.unlock();
+            return false;
+        }
+        value = this->buffer[this->indexRead];
+        this->indexRead = (this->indexRead + 1) % this->buffer.size();
+        this->size--;
+        this->spin.unlock();
+        return true;
+    }
+};
+
+struct LockFreeRing {
+    ConcurrencyQueue<uint32_t> queue;
+
+    LockFreeRing(uint32_t capacity) : queue(capacity) {}
+
+    bool push(uint32_t value) {
+        return this->queue.push(value) == Error::Nil;
+    }
+
+    bool pop(uint32_t& value) {
+        Result<uint32_t> result = this->queue.pop();
+        value = result.data;
+        return result.errorCode == Error::Nil;
+    }
+};
+
+template <typename Ring>
+static void benchmark(const char* name, uint32_t numberProducers, uint32_t numberConsumers, uint32_t numberValues) {
+    Ring ring(CAPACITY);
+    std::atomic<uint64_t> numberPopped(0);
+    uint64_t total = (uint64_t)numberProducers * numberValues;
+    uint64_t elapsed = runThreads(numberProducers + numberConsumers, [&](uint32_t idx) {
+        if (idx < numberProducers) {
+            for (uint32_t value = 0; value < numberValues; ++value) {
+                while (!ring.push(value)) {
+                    std::this_thread::yield();
+                }
+            }
+            return;
+        }
+        uint32_t value;
+        while (numberPopped.load(std::memory_order_relaxed) < total) {
+            if (ring.pop(value)) {
+                numberPopped.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    CHECK(numberPopped.load() == total);
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s (%u+%u)", name, numberProducers, numberConsumers);
+    reportThroughput(label, numberProducers + numberConsumers, total, elapsed);
+}
+
+int main(int argc, char** argv) {
+    uint32_t numberValues = isQuick(argc, argv) ? 1000 : 1000000;
+    const uint32_t configs[][2] = { {1, 1}, {2, 2}, {4, 1}, {1, 4}, {4, 4} };
+    for (auto& config : configs) {
+        benchmark<SpinLockRing>("SpinLock ring push/pop", config[0], config[1], numberValues);
+        benchmark<LockFreeRing>("ConcurrencyQueue push/pop", config[0], config[1], numberValues);
+    }
+    return 0;
+}
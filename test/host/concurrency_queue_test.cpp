@@ -0,0 +1,144 @@
+// "ConcurrencyQueue" with many producers and consumers, a small ring which wraps many times,
+// values which own memory and "drain" while producers still push
+#include <atomic>
+#include <memory>
+#include "host_test.h"
+#include "synchronization/concurrency_queue.h"
+
+#define NUMBER_VALUES 20000 // (per producer)
+
+static void testFullAndEmpty() {
+    ConcurrencyQueue<uint32_t> queue(3);
+    CHECK(queue.empty());
+    CHECK(queue.pop().errorCode == Error::Synchronization_ConcurrencyQueue_Empty);
+    // The capacity is rounded up to 4
+    for (uint32_t value = 0; value < 4; ++value) {
+        CHECK(queue.push(value) == Error::Nil);
+    }
+    uint32_t value = 4;
+    CHECK(queue.push(value) == Error::Synchronization_ConcurrencyQueue_Full);
+
+    uint32_t batch[8];
+    CHECK(queue.popBatch(batch, 3) == 3);
+    CHECK(batch[0] == 0 && batch[1] == 1 && batch[2] == 2);
+    Result<uint32_t> result = queue.pop();
+    CHECK(result.errorCode == Error::Nil && result.data == 3);
+    CHECK(queue.empty());
+}
+
+// Every consumer sees the values of a producer in order, no value is lost or popped twice
+static void testManyThreads(uint32_t capacity, uint32_t numberProducers, uint32_t numberConsumers, bool batch) {
+    ConcurrencyQueue<uint32_t> queue(capacity);
+    std::vector<std::atomic<uint32_t>> seen(numberProducers * NUMBER_VALUES);
+    std::atomic<uint64_t> numberPopped(0);
+    uint64_t total = (uint64_t)numberProducers * NUMBER_VALUES;
+    runThreads(numberProducers + numberConsumers, [&](uint32_t idx) {
+        if (idx < numberProducers) {
+            for (uint32_t seq = 0; seq < NUMBER_VALUES; ++seq) {
+                uint32_t value = idx * NUMBER_VALUES + seq;
+                while (queue.push(value) != Error::Nil) {
+                    std::this_thread::yield();
+                }
+            }
+            return;
+        }
+
+        std::vector<int64_t> lastSeqs(numberProducers, -1);
+        uint32_t values[16];
+        while (numberPopped.load() < total) {
+            uint32_t count = 0;
+            if (batch) {
+                count = queue.popBatch(values, 16);
+            } else {
+                Result<uint32_t> result = queue.pop();
+                if (result.errorCode == Error::Nil) {
+                    values[count++] = result.data;
+                }
+            }
+            if (count == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (uint32_t pos = 0; pos < count; ++pos) {
+                uint32_t producer = values[pos] / NUMBER_VALUES;
+                int64_t seq = values[pos] % NUMBER_VALUES;
+                CHECK(producer < numberProducers);
+                CHECK(seq > lastSeqs[producer]);
+                lastSeqs[producer] = seq;
+                CHECK(seen[values[pos]].fetch_add(1) == 0);
+            }
+            numberPopped += count;
+        }
+    });
+
+    CHECK(numberPopped.load() == total);
+    for (auto& count : seen) {
+        CHECK(count.load() == 1);
+    }
+    CHECK(queue.empty());
+}
+
+// Values which own memory are moved out once and the left ones are destroyed with the queue
+static void testOwnedValues() {
+    auto owner = std::make_shared<uint32_t>(7);
+    {
+        ConcurrencyQueue<std::shared_ptr<uint32_t>> queue(64);
+        std::atomic<uint64_t> numberPushed(0);
+        std::atomic<uint64_t> numberPopped(0);
+        runThreads(4, [&](uint32_t idx) {
+            for (uint32_t number = 0; number < NUMBER_VALUES / 10; ++number) {
+                if (idx < 2) {
+                    std::shared_ptr<uint32_t> value = owner;
+                    if (queue.push(value) == Error::Nil) {
+                        numberPushed++;
+                    }
+                } else {
+                    Result<std::shared_ptr<uint32_t>> result = queue.pop();
+                    if (result.errorCode == Error::Nil) {
+                        CHECK(*result.data == 7);
+                        numberPopped++;
+                    }
+                }
+            }
+        });
+        CHECK(owner.use_count() == 1 + (long)(numberPushed.load() - numberPopped.load()));
+    }
+    CHECK(owner.use_count() == 1);
+}
+
+// "drain" only returns when it saw the ring empty, it takes what the producers pushed until then
+static void testDrain() {
+    ConcurrencyQueue<uint32_t> queue(128);
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> numberDrained(0);
+    uint64_t total = 2ULL * NUMBER_VALUES;
+    runThreads(3, [&](uint32_t idx) {
+        if (idx < 2) {
+            for (uint32_t seq = 0; seq < NUMBER_VALUES; ++seq) {
+                while (queue.push(seq) != Error::Nil) {
+                    std::this_thread::yield();
+                }
+            }
+            return;
+        }
+        while (numberDrained.load() < total) {
+            numberDrained += queue.drain([](uint32_t&) {});
+        }
+        done = true;
+    });
+    CHECK(done.load());
+    CHECK(numberDrained.load() == total);
+    CHECK(queue.drain([](uint32_t&) {}) == 0);
+}
+
+int main() {
+    testFullAndEmpty();
+    testManyThreads(2, 1, 1, false);
+    testManyThreads(2, 4, 4, true);
+    testManyThreads(256, 1, 4, false);
+    testManyThreads(256, 4, 1, true);
+    testManyThreads(256, 4, 4, false);
+    testOwnedValues();
+    testDrain();
+    return 0;
+}
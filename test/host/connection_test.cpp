@@ -0,0 +1,172 @@
+// A large message goes end to end: its fragments are framed in envelopes like "listen" sends them,
+// a "Connection" writes them to a stand-in hub which relays the bytes to another "Connection",
+// and the fragments which it receives are reassembled. Frames of any 2-byte length are received
+#include <atomic>
+#include <poll.h>
+#include "host_test.h"
+#include "message/cipher.h"
+#include "cso_connection/connection.h"
+#include "cso_connector/send_window.h"
+#include "cso_connector/reassembler.h"
+
+#define LENGTH_MESSAGE 5000
+#define LENGTH_LARGE_MESSAGE 100000
+#define BATCH_SIZE 8
+#define WAIT_TIME 5000 // (milli seconds)
+
+// The longest name, so the envelope is the largest one
+static const char* RECEIVER_NAME = "receiver-000000-0000-0000-0000-00000";
+
+class Hub {
+public:
+    int listenSocket;
+    uint16_t port;
+    int senderSocket;
+    int receiverSocket;
+    std::atomic<bool> isDone;
+    std::thread relay;
+
+    Hub() : listenSocket(-1), port(0), senderSocket(-1), receiverSocket(-1), isDone(false) {
+        this->listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+        CHECK(this->listenSocket >= 0);
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t lenAddr = sizeof(addr);
+        CHECK(bind(this->listenSocket, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+        CHECK(listen(this->listenSocket, 2) == 0);
+        CHECK(getsockname(this->listenSocket, (struct sockaddr*)&addr, &lenAddr) == 0);
+        this->port = ntohs(addr.sin_port);
+    }
+
+    ~Hub() {
+        this->isDone.store(true);
+        if (this->relay.joinable()) {
+            this->relay.join();
+        }
+        close(this->senderSocket);
+        close(this->receiverSocket);
+        close(this->listenSocket);
+    }
+
+    // Takes the connections in the order in which they connected
+    int accept() {
+        int socket = ::accept(this->listenSocket, nullptr, nullptr);
+        CHECK(socket >= 0);
+        return socket;
+    }
+
+    // Copies the bytes of the sender to the receiver as they come, frames are not looked at
+    void start() {
+        this->relay = std::thread([this] {
+            uint8_t buffer[700];
+            struct pollfd fd = { this->senderSocket, POLLIN, 0 };
+            while (!this->isDone.load()) {
+                if (poll(&fd, 1, 10) <= 0) {
+                    continue;
+                }
+                ssize_t received = recv(this->senderSocket, buffer, sizeof(buffer), 0);
+                if (received <= 0) {
+                    return;
+                }
+                for (ssize_t seek = 0; seek < received;) {
+                    ssize_t sent = send(this->receiverSocket, buffer + seek, received - seek, MSG_NOSIGNAL);
+                    CHECK(sent > 0);
+                    seek += sent;
+                }
+            }
+        });
+    }
+};
+
+// Frames every fragment of "message" like "queueFragments" and the parser, without encryption
+static std::vector<Array<uint8_t>> buildFrames(const uint8_t* message, uint32_t lenMessage, uint16_t maxFragmentSize) {
+    std::vector<Array<uint8_t>> frames;
+    uint8_t fragment[UINT16_MAX];
+    uint8_t sign[LENGTH_SIGN_HMAC] = { 0 };
+    uint32_t transferID = 7;
+    uint16_t lenFragment = maxFragmentSize - FRAGMENT_HEADER_SIZE;
+    for (uint32_t offset = 0; offset < lenMessage; offset += lenFragment) {
+        uint32_t lenPart = lenMessage - offset < lenFragment ? lenMessage - offset : lenFragment;
+        memcpy(fragment, &transferID, sizeof(uint32_t));
+        memcpy(fragment + 4, &lenMessage, sizeof(uint32_t));
+        memcpy(fragment + 8, &offset, sizeof(uint32_t));
+        memcpy(fragment + FRAGMENT_HEADER_SIZE, message + offset, lenPart);
+        bool isFirst = offset == 0;
+        bool isLast = !isFirst && offset + lenPart == lenMessage;
+        uint64_t msgID = frames.size() + 1;
+        Result<Array<uint8_t>> frame = Cipher::buildNoCipherBytes(msgID, msgID, MessageType::Single, isFirst, isLast, true,
+            RECEIVER_NAME, strlen(RECEIVER_NAME), fragment, lenPart + FRAGMENT_HEADER_SIZE, sign);
+        CHECK(frame.errorCode == Error::Nil);
+        frames.push_back(std::move(frame.data));
+    }
+    return frames;
+}
+
+// Receives frames until the message is complete, returns its slot
+static uint8_t receiveMessage(IConnection* receiver, Reassembler* reassembler) {
+    Array<uint8_t> batch[BATCH_SIZE];
+    uint64_t deadline = TIMESTAMP_MICRO_SECS() + WAIT_TIME * 1000ULL;
+    while (TIMESTAMP_MICRO_SECS() < deadline) {
+        receiver->waitMessage(10);
+        CHECK(receiver->receive() == Error::Nil);
+        uint32_t number = receiver->getMessages(batch, BATCH_SIZE);
+        for (uint32_t idx = 0; idx < number; ++idx) {
+            Result<std::unique_ptr<Cipher>> msg = Cipher::parseBytes(batch[idx].buffer.get(), batch[idx].length);
+            CHECK(msg.errorCode == Error::Nil);
+            uint8_t slot = 0xFF;
+            CHECK(reassembler->addFragment(msg.data->getName(), msg.data->getData(), msg.data->getSizeData(), slot) == Error::Nil);
+            if (reassembler->isComplete(slot)) {
+                return slot;
+            }
+        }
+    }
+    CHECK(false);
+    return 0xFF;
+}
+
+static uint8_t message[LENGTH_LARGE_MESSAGE];
+
+// Fragments of "maxFragmentSize" in frames of 1 KB and less are what receivers on older firmware read
+static void testLargeMessage(uint32_t lenMessage, uint16_t maxFragmentSize, bool isBatch) {
+    Hub hub;
+    std::unique_ptr<IConnection> sender = Connection::build(64);
+    CHECK(sender->connect("127.0.0.1", hub.port) == Error::Nil);
+    hub.senderSocket = hub.accept();
+    std::unique_ptr<IConnection> receiver = Connection::build(64);
+    CHECK(receiver->connect("127.0.0.1", hub.port) == Error::Nil);
+    hub.receiverSocket = hub.accept();
+    hub.start();
+
+    for (uint32_t idx = 0; idx < lenMessage; ++idx) {
+        message[idx] = (uint8_t)(idx * 7);
+    }
+    std::vector<Array<uint8_t>> frames = buildFrames(message, lenMessage, maxFragmentSize);
+    CHECK(frames.size() > 1);
+    for (auto& frame : frames) {
+        CHECK(maxFragmentSize > SendWindow().maxFragmentSize || frame.length <= 1024);
+    }
+    if (isBatch) {
+        CHECK(sender->sendMessages(frames.data(), frames.size()) == Error::Nil);
+    } else {
+        for (auto& frame : frames) {
+            CHECK(sender->sendMessage(frame.buffer.get(), frame.length) == Error::Nil);
+        }
+    }
+
+    std::unique_ptr<Reassembler> reassembler = Reassembler::build(1, LENGTH_LARGE_MESSAGE, WAIT_TIME);
+    uint8_t slot = receiveMessage(receiver.get(), reassembler.get());
+    CHECK(reassembler->getLength(slot) == lenMessage);
+    CHECK(memcmp(reassembler->getContent(slot), message, lenMessage) == 0);
+    reassembler->release(slot);
+}
+
+int main() {
+    uint16_t maxFragmentSize = SendWindow().maxFragmentSize;
+    testLargeMessage(LENGTH_MESSAGE, maxFragmentSize, false);
+    testLargeMessage(LENGTH_MESSAGE, maxFragmentSize, true);
+    // Frames up to the largest "data length" are received whole
+    testLargeMessage(LENGTH_MESSAGE, 2000, false);
+    testLargeMessage(LENGTH_LARGE_MESSAGE, UINT16_MAX - MAX_ENVELOPE_SIZE, true);
+    return 0;
+}
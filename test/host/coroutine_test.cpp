@@ -0,0 +1,201 @@
+// Awaitable API of "IConnector" (C++20) on a fake connector, the test plays "listen"
+// and completes sends, calls and subscriptions
+#include <atomic>
+#include "host_test.h"
+#include "cso_connector/coroutine.h"
+
+#define NUMBER_ROUNDS 2000
+
+class FakeConnector : public IConnector {
+public:
+    SendCallback sendCallback = nullptr;
+    void* sendContext = nullptr;
+    CallCallback callCallback = nullptr;
+    void* callContext = nullptr;
+    MessageHandler handler = nullptr;
+    void* handlerContext = nullptr;
+    uint32_t numberSubscriptions = 0;
+    // Sends which can not be queued complete at once
+    bool isFull = false;
+    // Sends complete on another thread, at about the time the coroutine suspends
+    bool isThreaded = false;
+    std::thread completer;
+
+    void run(Error::Code (*)(const char*, uint8_t*, uint16_t)) override {}
+    void listen(Error::Code (*)(const char*, uint8_t*, uint16_t)) override {}
+    void listen(Error::Code (*)(const char*, uint8_t*, uint16_t), uint32_t) override {}
+    uint32_t getWaitTime(uint32_t timeout) override { return timeout; }
+    Error::Code sendMessage(const char*, uint8_t*, uint16_t, bool, bool) override { return Error::Nil; }
+    Error::Code sendGroupMessage(const char*, uint8_t*, uint16_t, bool, bool) override { return Error::Nil; }
+    Error::Code sendMessageAndRetry(const char*, uint8_t*, uint16_t, bool, int32_t, Priority::Code, uint32_t) override { return Error::Nil; }
+    Error::Code sendGroupMessageAndRetry(const char*, uint8_t*, uint16_t, bool, int32_t, Priority::Code, uint32_t) override { return Error::Nil; }
+    Error::Code sendMessages(const OutboundMessage*, uint16_t) override { return Error::Nil; }
+    Error::Code sendMessagesAndRetry(const OutboundMessage*, uint16_t, int32_t, Priority::Code, uint32_t) override { return Error::Nil; }
+
+    Result<uint64_t> sendMessageAsync(const char*, uint8_t*, uint16_t, bool, int32_t, SendCallback onComplete, void* context, Priority::Code, uint32_t) override {
+        if (this->isFull) {
+            onComplete(0, SendStatus::QueueFull, context);
+            return Result<uint64_t>(Error::CSOConnector_MessageQueueFull, 0);
+        }
+        if (this->isThreaded) {
+            this->completer = std::thread([onComplete, context] {
+                onComplete(7, SendStatus::Acked, context);
+            });
+            return Result<uint64_t>(Error::Nil, 7);
+        }
+        this->sendCallback = onComplete;
+        this->sendContext = context;
+        return Result<uint64_t>(Error::Nil, 7);
+    }
+
+    Result<uint64_t> sendGroupMessageAsync(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority, uint32_t ttl) override {
+        return sendMessageAsync(groupName, content, lenContent, isEncrypted, retry, onComplete, context, priority, ttl);
+    }
+
+    Result<uint64_t> sendLargeMessage(const char*, const uint8_t*, uint32_t, bool, int32_t, SendCallback, void*, Priority::Code) override { return Result<uint64_t>(Error::Nil, 0); }
+    Result<uint64_t> sendGroupLargeMessage(const char*, const uint8_t*, uint32_t, bool, int32_t, SendCallback, void*, Priority::Code) override { return Result<uint64_t>(Error::Nil, 0); }
+    void setLargeMessageCallback(Error::Code (*)(const char*, uint8_t*, uint32_t)) override {}
+
+    Result<uint32_t> call(const char*, const uint8_t*, uint16_t, bool, int32_t, uint32_t, CallCallback onComplete, void* context, Priority::Code) override {
+        this->callCallback = onComplete;
+        this->callContext = context;
+        return Result<uint32_t>(Error::Nil, 3);
+    }
+
+    void setCallHandler(Error::Code (*)(const char*, uint8_t*, uint16_t, Array<uint8_t>&)) override {}
+    CallStats getCallStats() override { return CallStats(); }
+
+    Result<uint32_t> subscribeGroup(const char*, MessageHandler handler, void* context) override {
+        this->handler = handler;
+        this->handlerContext = context;
+        this->numberSubscriptions++;
+        return Result<uint32_t>(Error::Nil, 1);
+    }
+
+    Result<uint32_t> subscribeSender(const char* sender, MessageHandler handler, void* context) override {
+        return subscribeGroup(sender, handler, context);
+    }
+
+    void unsubscribe(uint32_t) override {
+        this->numberSubscriptions--;
+    }
+
+    LaneStats getLaneStats(Priority::Code) override { return LaneStats(); }
+    CongestionStats getCongestionStats() override { return CongestionStats(); }
+};
+
+class SessionState {
+public:
+    uint32_t step = 0;
+    SendResult send = {0, SendStatus::Dropped};
+    CallStatus::Code callStatus = CallStatus::Dropped;
+    uint16_t lenResponse = 0;
+    char sender[MAX_CONNECTION_NAME_LENGTH + 1] = { 0 };
+    std::atomic<bool> isDone{false};
+};
+
+static Task sendSession(IConnector& connector, SessionState& state) {
+    uint8_t content[4] = { 1, 2, 3, 4 };
+    state.step = 1;
+    state.send = co_await awaitSend(connector, "peer", content, sizeof(content), false, 3);
+    state.step = 2;
+    state.isDone.store(true);
+}
+
+static Task callSession(IConnector& connector, SessionState& state) {
+    uint8_t request[2] = { 9, 9 };
+    CallResult result = co_await awaitCall(connector, "peer", request, sizeof(request), false, 3, 1000);
+    state.callStatus = result.status;
+    state.lenResponse = result.response.length;
+    state.isDone.store(true);
+}
+
+static Task receiveSession(Inbox& inbox, SessionState& state) {
+    for (state.step = 0; state.step < 3; ++state.step) {
+        Inbox::Message message = co_await inbox.receive();
+        CHECK(message.data.length == 1 && message.data.buffer.get()[0] == state.step);
+        strcpy(state.sender, message.sender);
+    }
+    state.isDone.store(true);
+}
+
+// The coroutine is suspended until "listen" completes the send
+static void testSend() {
+    FakeConnector connector;
+    SessionState state;
+    sendSession(connector, state);
+    CHECK(state.step == 1);
+    CHECK(connector.sendCallback != nullptr);
+    connector.sendCallback(7, SendStatus::Acked, connector.sendContext);
+    CHECK(state.isDone.load());
+    CHECK(state.send.msgID == 7 && state.send.status == SendStatus::Acked);
+}
+
+// A send which completes at once does not suspend
+static void testSendFull() {
+    FakeConnector connector;
+    connector.isFull = true;
+    SessionState state;
+    sendSession(connector, state);
+    CHECK(state.isDone.load());
+    CHECK(state.send.status == SendStatus::QueueFull);
+}
+
+// The callback runs on another thread, whichever of it and "await_suspend" comes second resumes
+static void testSendThreaded() {
+    for (uint32_t round = 0; round < NUMBER_ROUNDS; ++round) {
+        FakeConnector connector;
+        connector.isThreaded = true;
+        SessionState state;
+        sendSession(connector, state);
+        connector.completer.join();
+        CHECK(state.isDone.load());
+        CHECK(state.send.status == SendStatus::Acked);
+    }
+}
+
+// The response is copied, it is only valid during the callback
+static void testCall() {
+    FakeConnector connector;
+    SessionState state;
+    callSession(connector, state);
+    CHECK(!state.isDone.load());
+    uint8_t response[5] = { 0 };
+    connector.callCallback(3, CallStatus::Replied, response, sizeof(response), connector.callContext);
+    memset(response, 0xFF, sizeof(response));
+    CHECK(state.isDone.load());
+    CHECK(state.callStatus == CallStatus::Replied && state.lenResponse == sizeof(response));
+}
+
+// Messages wait in the inbox until the coroutine receives them, a full inbox refuses more
+static void testInbox() {
+    FakeConnector connector;
+    {
+        std::unique_ptr<Inbox> inbox = Inbox::build(connector, true, "group", 2);
+        CHECK(connector.numberSubscriptions == 1);
+        uint8_t data[1] = { 0 };
+        CHECK(connector.handler("alice", data, 1, connector.handlerContext) == Error::Nil);
+        data[0] = 1;
+        CHECK(connector.handler("bob", data, 1, connector.handlerContext) == Error::Nil);
+        data[0] = 2;
+        CHECK(connector.handler("carol", data, 1, connector.handlerContext) == Error::CSOConnector_InboxFull);
+
+        SessionState state;
+        receiveSession(*inbox, state);
+        CHECK(!state.isDone.load() && state.step == 2);
+        CHECK(strcmp(state.sender, "bob") == 0);
+        CHECK(connector.handler("carol", data, 1, connector.handlerContext) == Error::Nil);
+        CHECK(state.isDone.load());
+        CHECK(strcmp(state.sender, "carol") == 0);
+    }
+    CHECK(connector.numberSubscriptions == 0);
+}
+
+int main() {
+    testSend();
+    testSendFull();
+    testSendThreaded();
+    testCall();
+    testInbox();
+    return 0;
+}
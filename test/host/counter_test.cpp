@@ -0,0 +1,72 @@
+// Write indexes of "Counter" taken by many threads, also across the half and word boundaries
+// of the low 32-bit atomic and across "UINT64_MAX"
+#include <algorithm>
+#include "host_test.h"
+#include "cso_counter/counter.h"
+
+#define NUMBER_THREADS 8
+#define NUMBER_INDEXES 20000 // (per thread)
+
+// "build" and the constructor each step back one index, as the spinlock counter did
+static uint64_t getFirstIndex(uint64_t writeIndex) {
+    return writeIndex - 2;
+}
+
+static void testSingleThread(uint64_t writeIndex) {
+    std::unique_ptr<ICounter> counter = Counter::build(writeIndex);
+    uint64_t expected = getFirstIndex(writeIndex);
+    for (uint32_t idx = 0; idx < 3 * NUMBER_INDEXES; ++idx) {
+        CHECK(counter->nextWriteIndex() == expected);
+        expected++;
+    }
+}
+
+// Every index is taken once, there are no gaps and every thread sees its indexes increase
+static void testManyThreads(uint64_t writeIndex) {
+    std::unique_ptr<ICounter> counter = Counter::build(writeIndex);
+    uint64_t first = getFirstIndex(writeIndex);
+    std::vector<std::vector<uint64_t>> offsets(NUMBER_THREADS);
+    runThreads(NUMBER_THREADS, [&](uint32_t idx) {
+        offsets[idx].reserve(NUMBER_INDEXES);
+        for (uint32_t number = 0; number < NUMBER_INDEXES; ++number) {
+            offsets[idx].push_back(counter->nextWriteIndex() - first);
+        }
+    });
+
+    std::vector<uint64_t> all;
+    for (auto& part : offsets) {
+        for (size_t idx = 1; idx < part.size(); ++idx) {
+            CHECK(part[idx] > part[idx - 1]);
+        }
+        all.insert(all.end(), part.begin(), part.end());
+    }
+    std::sort(all.begin(), all.end());
+    for (size_t idx = 0; idx < all.size(); ++idx) {
+        CHECK(all[idx] == idx);
+    }
+}
+
+int main() {
+    const uint64_t half = 0x80000000ULL;
+    const uint64_t word = 0x100000000ULL;
+    const uint64_t margin = NUMBER_THREADS * NUMBER_INDEXES / 2;
+    const uint64_t writeIndexes[] = {
+        0,
+        1,
+        2,
+        1000,
+        half - margin,
+        half,
+        word - margin,
+        word,
+        5 * word + half - margin,
+        0x8000000000000000ULL - margin,
+        UINT64_MAX - margin,
+        UINT64_MAX,
+    };
+    for (uint64_t writeIndex : writeIndexes) {
+        testSingleThread(writeIndex);
+        testManyThreads(writeIndex);
+    }
+    return 0;
+}
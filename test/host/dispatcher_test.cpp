@@ -0,0 +1,102 @@
+// "Dispatcher" with many workers: every message wakes up an idle worker,
+// callbacks run side by side and every message is delivered once with its sender and data
+#include <atomic>
+#include "host_test.h"
+#include "cso_connector/dispatcher.h"
+#include "synchronization/semaphore.h"
+
+#define NUMBER_WORKERS 4
+#define NUMBER_MESSAGES 20000
+#define WAIT_TIME 5000 // (milli seconds)
+// Workers also poll every 100 milli seconds, a wakeup has to come much earlier
+#define MAX_WAKEUP_TIME 50000 // (micro seconds)
+
+// Notifications which are given together wake up as many waiters
+static void testSemaphore() {
+    Semaphore semaphore(16);
+    std::atomic<uint32_t> numberWoken(0);
+    uint64_t elapsed = runThreads(NUMBER_WORKERS + 1, [&](uint32_t idx) {
+        if (idx < NUMBER_WORKERS) {
+            if (semaphore.wait(WAIT_TIME)) {
+                numberWoken++;
+            }
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        for (uint32_t number = 0; number < NUMBER_WORKERS; ++number) {
+            semaphore.notify();
+        }
+    });
+    CHECK(numberWoken.load() == NUMBER_WORKERS);
+    CHECK(elapsed < WAIT_TIME * 1000ULL / 2);
+    // Nothing is left
+    CHECK(!semaphore.wait(1));
+}
+
+static std::atomic<uint32_t> numberRunning(0);
+static std::atomic<bool> isReleased(false);
+
+static Error::Code blockCallback(const char*, uint8_t*, uint16_t) {
+    numberRunning++;
+    while (!isReleased.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return Error::Nil;
+}
+
+// Workers are busy with earlier callbacks, a new message is taken by an idle worker at once
+static void testIdleWorkers() {
+    numberRunning.store(0);
+    isReleased.store(false);
+    std::unique_ptr<Dispatcher> dispatcher = Dispatcher::build(64, NUMBER_WORKERS);
+    uint8_t data[4] = { 1, 2, 3, 4 };
+    for (uint32_t number = 1; number <= NUMBER_WORKERS; ++number) {
+        uint64_t start = TIMESTAMP_MICRO_SECS();
+        CHECK(dispatcher->dispatch(blockCallback, "sender", data, sizeof(data)) == Error::Nil);
+        while (numberRunning.load() < number) {
+            CHECK(TIMESTAMP_MICRO_SECS() - start < MAX_WAKEUP_TIME);
+            std::this_thread::yield();
+        }
+    }
+    isReleased.store(true);
+}
+
+static std::atomic<uint64_t> numberDelivered(0);
+static std::atomic<uint64_t> sumDelivered(0);
+
+static Error::Code countCallback(const char* sender, uint8_t* data, uint16_t lenData) {
+    CHECK(strcmp(sender, "sender") == 0);
+    CHECK(lenData == sizeof(uint32_t));
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    sumDelivered += value;
+    numberDelivered++;
+    return Error::Nil;
+}
+
+static void testDeliverAll() {
+    numberDelivered.store(0);
+    sumDelivered.store(0);
+    {
+        std::unique_ptr<Dispatcher> dispatcher = Dispatcher::build(64, NUMBER_WORKERS);
+        for (uint32_t value = 0; value < NUMBER_MESSAGES; ++value) {
+            while (dispatcher->dispatch(countCallback, "sender", reinterpret_cast<uint8_t*>(&value), sizeof(value)) != Error::Nil) {
+                std::this_thread::yield();
+            }
+        }
+        uint64_t start = TIMESTAMP_MICRO_SECS();
+        while (numberDelivered.load() < NUMBER_MESSAGES) {
+            CHECK(TIMESTAMP_MICRO_SECS() - start < WAIT_TIME * 1000ULL);
+            std::this_thread::yield();
+        }
+    }
+    CHECK(numberDelivered.load() == NUMBER_MESSAGES);
+    CHECK(sumDelivered.load() == (uint64_t)NUMBER_MESSAGES * (NUMBER_MESSAGES - 1) / 2);
+}
+
+int main() {
+    testSemaphore();
+    testIdleWorkers();
+    testDeliverAll();
+    return 0;
+}
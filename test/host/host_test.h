@@ -0,0 +1,44 @@
+#ifndef _TEST_HOST_HOST_TEST_H_
+#define _TEST_HOST_HOST_TEST_H_
+
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include "synchronization/clock.h"
+
+// "CHECK" stops the test at the first failed condition, ctest sees the exit code
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+        exit(1); \
+    } \
+} while (0)
+
+// Benchmarks take "--quick" from ctest, they only check that they run then
+inline bool isQuick(int argc, char** argv) {
+    return argc > 1 && strcmp(argv[1], "--quick") == 0;
+}
+
+// Runs "fn(idx)" on "number" threads and returns the elapsed time (micro seconds)
+template <typename Fn>
+uint64_t runThreads(uint32_t number, Fn fn) {
+    std::vector<std::thread> threads;
+    uint64_t start = TIMESTAMP_MICRO_SECS();
+    for (uint32_t idx = 0; idx < number; ++idx) {
+        threads.emplace_back(fn, idx);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return TIMESTAMP_MICRO_SECS() - start;
+}
+
+inline void reportThroughput(const char* name, uint32_t numberThreads, uint64_t numberOperations, uint64_t elapsed) {
+    double seconds = elapsed > 0 ? elapsed / 1000000.0 : 1e-6;
+    printf("%-40s %2u threads %10.3f Mops/s\n", name, numberThreads, numberOperations / seconds / 1000000.0);
+}
+
+#endif //_TEST_HOST_HOST_TEST_H_
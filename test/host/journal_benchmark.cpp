@@ -0,0 +1,87 @@
+// Cost of "Journal" for reliable messages: throughput of push and clear through "Queue",
+// enqueue latency and file writes per message for several batch capacities (group commit).
+// The journal is a file of the working directory, on the esp32 it is on SPIFFS or LittleFS
+#include "host_test.h"
+#include "cso_queue/queue.h"
+
+#define JOURNAL_PATH "journal_benchmark.log"
+#define CAPACITY 64
+#define LENGTH_CONTENT 48
+
+static const uint8_t LANE_WEIGHTS[NUMBER_PRIORITIES] = { 0, 4, 1 };
+
+static void pushMessages(IQueue* queue, uint64_t firstMsgID, uint32_t number) {
+    uint8_t content[LENGTH_CONTENT] = { 0 };
+    for (uint32_t idx = 0; idx < number; ++idx) {
+        CHECK(queue->takeIndex());
+        Error::Code error = queue->pushMessage(firstMsgID + idx, 0, "receiver", content, sizeof(content),
+            false, false, true, true, true, false, Priority::Normal, 1, 0, nullptr, nullptr);
+        CHECK(error == Error::Nil);
+    }
+}
+
+// "batchCapacity" is 0 without a journal
+static void benchmark(uint32_t batchCapacity, uint32_t numberMessages) {
+    remove(JOURNAL_PATH);
+    std::shared_ptr<Journal> journal;
+    if (batchCapacity > 0) {
+        journal = Journal::build(JOURNAL_PATH, batchCapacity, 100, 65536);
+    }
+    std::unique_ptr<IQueue> queue = Queue::build(CAPACITY, CAPACITY, 64, LANE_WEIGHTS, journal);
+
+    uint64_t msgID = 1;
+    uint64_t start = TIMESTAMP_MICRO_SECS();
+    while (msgID <= numberMessages) {
+        uint32_t number = CAPACITY / 2;
+        pushMessages(queue.get(), msgID, number);
+        msgID += number;
+        for (uint32_t idx = 0; idx < number; ++idx) {
+            ItemQueueRef ref = queue->nextMessage();
+            CHECK(!ref.empty());
+            queue->clearMessage(ref.get().msgID);
+        }
+    }
+    uint64_t elapsed = TIMESTAMP_MICRO_SECS() - start;
+
+    char name[64];
+    if (journal == nullptr) {
+        snprintf(name, sizeof(name), "Queue without journal");
+        reportThroughput(name, 1, msgID - 1, elapsed);
+        return;
+    }
+    journal->sync(true);
+    JournalStats stats = journal->getStats();
+    snprintf(name, sizeof(name), "Queue with journal (batch %u bytes)", batchCapacity);
+    reportThroughput(name, 1, msgID - 1, elapsed);
+    printf("    enqueue %6.2f us avg %8llu us max, %6.3f writes/message\n",
+        stats.numberMessages > 0 ? (double)stats.totalEnqueueTime / stats.numberMessages : 0.0,
+        (unsigned long long)stats.maxEnqueueTime,
+        stats.numberMessages > 0 ? (double)stats.numberWrites / stats.numberMessages : 0.0);
+}
+
+// Messages which were not cleared come back after a restart
+static void checkReplay() {
+    remove(JOURNAL_PATH);
+    {
+        std::unique_ptr<IQueue> queue = Queue::build(CAPACITY, CAPACITY, 64, LANE_WEIGHTS, Journal::build(JOURNAL_PATH));
+        pushMessages(queue.get(), 1, 10);
+        for (uint32_t idx = 0; idx < 4; ++idx) {
+            ItemQueueRef ref = queue->nextMessage();
+            CHECK(!ref.empty());
+            queue->clearMessage(ref.get().msgID);
+        }
+    }
+    std::unique_ptr<IQueue> queue = Queue::build(CAPACITY, CAPACITY, 64, LANE_WEIGHTS, Journal::build(JOURNAL_PATH));
+    CHECK(queue->getLaneStats(Priority::Normal).depth == 6);
+}
+
+int main(int argc, char** argv) {
+    uint32_t numberMessages = isQuick(argc, argv) ? 256 : 20000;
+    checkReplay();
+    const uint32_t batchCapacities[] = { 0, 64, 1024, 8192 };
+    for (uint32_t batchCapacity : batchCapacities) {
+        benchmark(batchCapacity, numberMessages);
+    }
+    remove(JOURNAL_PATH);
+    return 0;
+}
@@ -0,0 +1,261 @@
+// Runs thousands of "LoadGenerator" clients against a local stand-in hub and reports their
+// traffic and the memory of one client.
+//
+//   load_tool [numberClients] [seconds]
+//
+// A client is a "HubClient": the parts of a connector which build on the host (queue, counters,
+// reassembler, call and subscription tables, pacer) without the connection, parser and proxy,
+// which need mbedtls. The hub plays "listen" of every client on one thread, it takes the next
+// message of a queue and acks it. The memory of a client is counted by "operator new" below.
+#include <new>
+#include <atomic>
+#include <memory>
+#include "host_test.h"
+#include "cso_queue/queue.h"
+#include "cso_counter/counter.h"
+#include "cso_counter/sender_counter.h"
+#include "cso_connector/interface.h"
+#include "cso_connector/send_window.h"
+#include "cso_connector/reassembler.h"
+#include "cso_connector/call_table.h"
+#include "cso_connector/subscription_table.h"
+#include "cso_connector/pacer.h"
+#include "cso_load/load_generator.h"
+
+#define NUMBER_CLIENTS 2000
+#define NUMBER_SECONDS 5
+#define QUICK_CLIENTS 100
+#define QUICK_MILLI_SECONDS 200
+// "bufferSize" of "src/main.cpp"
+#define QUEUE_SIZE 256
+#define STEP_INTERVAL 1000 // (micro seconds)
+
+// Bytes which "new" has allocated and not deleted yet, a header in front of every block keeps its size.
+// Every form of "new" and "delete" is replaced, the sanitizers bring their own array and nothrow forms
+static std::atomic<int64_t> numberLiveBytes(0);
+
+#define HEADER_SIZE 16
+
+static void* allocate(size_t size) noexcept {
+    uint8_t* block = static_cast<uint8_t*>(malloc(size + HEADER_SIZE));
+    if (block == nullptr) {
+        return nullptr;
+    }
+    *reinterpret_cast<size_t*>(block) = size;
+    numberLiveBytes += size;
+    return block + HEADER_SIZE;
+}
+
+static void release(void* ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    uint8_t* block = static_cast<uint8_t*>(ptr) - HEADER_SIZE;
+    numberLiveBytes -= *reinterpret_cast<size_t*>(block);
+    free(block);
+}
+
+void* operator new(size_t size) {
+    void* ptr = allocate(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept { release(ptr); }
+void operator delete[](void* ptr) noexcept { release(ptr); }
+void operator delete(void* ptr, size_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { release(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+
+class HubClient : public IConnector {
+private:
+    std::unique_ptr<IQueue> queue;
+    std::unique_ptr<ICounter> counter;
+    std::unique_ptr<SenderCounter> senderCounter;
+    std::unique_ptr<Reassembler> reassembler;
+    std::unique_ptr<CallTable> calls;
+    std::unique_ptr<SubscriptionTable> subscriptions;
+    std::unique_ptr<Pacer> pacer;
+    std::atomic<uint64_t>* numberBytes;
+
+public:
+    explicit HubClient(std::atomic<uint64_t>* numberBytes)
+        : queue(Queue::build(QUEUE_SIZE, SendWindow().maxInFlight)),
+          counter(Counter::build(1)),
+          senderCounter(SenderCounter::build()),
+          reassembler(Reassembler::build()),
+          calls(CallTable::build()),
+          subscriptions(SubscriptionTable::build()),
+          pacer(Pacer::build()),
+          numberBytes(numberBytes) {}
+
+    // Acks the next message of the queue like "listen" would after its "Done", returns false if there is none
+    bool serve() {
+        ItemQueueRef ref = this->queue->nextMessage();
+        if (ref.empty()) {
+            return false;
+        }
+        this->numberBytes->fetch_add(ref.get().lenContent);
+        this->queue->clearMessage(ref.get().msgID);
+        return true;
+    }
+
+    void run(Error::Code (*)(const char*, uint8_t*, uint16_t)) override {}
+    void listen(Error::Code (*)(const char*, uint8_t*, uint16_t)) override {}
+    void listen(Error::Code (*)(const char*, uint8_t*, uint16_t), uint32_t) override {}
+    uint32_t getWaitTime(uint32_t timeout) override { return timeout; }
+
+    // Messages which are sent once reach the hub at once
+    Error::Code sendMessage(const char*, uint8_t*, uint16_t lenContent, bool, bool) override {
+        this->numberBytes->fetch_add(lenContent);
+        return Error::Nil;
+    }
+
+    Error::Code sendGroupMessage(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, bool isCache) override {
+        return sendMessage(groupName, content, lenContent, isEncrypted, isCache);
+    }
+
+    Error::Code sendMessageAndRetry(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, Priority::Code priority, uint32_t ttl) override {
+        return sendMessageAsync(recvName, content, lenContent, isEncrypted, retry, nullptr, nullptr, priority, ttl).errorCode;
+    }
+
+    Error::Code sendGroupMessageAndRetry(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, Priority::Code priority, uint32_t ttl) override {
+        return sendMessageAndRetry(groupName, content, lenContent, isEncrypted, retry, priority, ttl);
+    }
+
+    Error::Code sendMessages(const OutboundMessage*, uint16_t) override { return Error::Nil; }
+    Error::Code sendMessagesAndRetry(const OutboundMessage*, uint16_t, int32_t, Priority::Code, uint32_t) override { return Error::Nil; }
+
+    // Reliable messages go through the queue like "doSendMessageRetry"
+    Result<uint64_t> sendMessageAsync(const char* recvName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority, uint32_t ttl) override {
+        if (!this->queue->takeIndex()) {
+            if (onComplete != nullptr) {
+                onComplete(0, SendStatus::QueueFull, context);
+            }
+            return Result<uint64_t>(Error::CSOConnector_MessageQueueFull, 0);
+        }
+        uint64_t msgID = this->counter->nextWriteIndex();
+        Error::Code error = this->queue->pushMessage(msgID, 0, recvName, content, lenContent, isEncrypted, false,
+            true, true, true, false, priority, retry + 1, ttl, onComplete, context);
+        if (error != Error::Nil) {
+            if (onComplete != nullptr) {
+                onComplete(0, SendStatus::Dropped, context);
+            }
+            return Result<uint64_t>(error, 0);
+        }
+        return Result<uint64_t>(Error::Nil, msgID);
+    }
+
+    Result<uint64_t> sendGroupMessageAsync(const char* groupName, uint8_t* content, uint16_t lenContent, bool isEncrypted, int32_t retry, SendCallback onComplete, void* context, Priority::Code priority, uint32_t ttl) override {
+        return sendMessageAsync(groupName, content, lenContent, isEncrypted, retry, onComplete, context, priority, ttl);
+    }
+
+    Result<uint64_t> sendLargeMessage(const char*, const uint8_t*, uint32_t, bool, int32_t, SendCallback, void*, Priority::Code) override { return Result<uint64_t>(Error::Nil, 0); }
+    Result<uint64_t> sendGroupLargeMessage(const char*, const uint8_t*, uint32_t, bool, int32_t, SendCallback, void*, Priority::Code) override { return Result<uint64_t>(Error::Nil, 0); }
+    void setLargeMessageCallback(Error::Code (*)(const char*, uint8_t*, uint32_t)) override {}
+    Result<uint32_t> call(const char*, const uint8_t*, uint16_t, bool, int32_t, uint32_t, CallCallback, void*, Priority::Code) override { return Result<uint32_t>(Error::Nil, 0); }
+    void setCallHandler(Error::Code (*)(const char*, uint8_t*, uint16_t, Array<uint8_t>&)) override {}
+    CallStats getCallStats() override { return this->calls->getStats(); }
+    Result<uint32_t> subscribeGroup(const char*, MessageHandler, void*) override { return Result<uint32_t>(Error::Nil, 0); }
+    Result<uint32_t> subscribeSender(const char*, MessageHandler, void*) override { return Result<uint32_t>(Error::Nil, 0); }
+    void unsubscribe(uint32_t) override {}
+    LaneStats getLaneStats(Priority::Code priority) override { return this->queue->getLaneStats(priority); }
+    CongestionStats getCongestionStats() override { return this->queue->getCongestionStats(); }
+};
+
+int main(int argc, char** argv) {
+    bool quick = isQuick(argc, argv);
+    uint32_t numberClients = quick ? QUICK_CLIENTS : NUMBER_CLIENTS;
+    uint64_t duration = quick ? QUICK_MILLI_SECONDS * 1000ULL : NUMBER_SECONDS * 1000000ULL;
+    if (!quick && argc > 1) {
+        numberClients = (uint32_t)strtoul(argv[1], nullptr, 10);
+    }
+    if (!quick && argc > 2) {
+        duration = strtoull(argv[2], nullptr, 10) * 1000000ULL;
+    }
+    CHECK(numberClients > 0);
+
+    // 10 messages per second of 16 to 256 bytes, half of them are reliable
+    LoadMix mix(10, 16, 256, 50, 50);
+    std::atomic<uint64_t> numberBytes(0);
+    std::vector<std::unique_ptr<HubClient>> clients;
+    std::vector<std::unique_ptr<LoadGenerator>> generators;
+    clients.reserve(numberClients);
+    generators.reserve(numberClients);
+
+    int64_t start = numberLiveBytes.load();
+    for (uint32_t idx = 0; idx < numberClients; ++idx) {
+        clients.emplace_back(new HubClient(&numberBytes));
+    }
+    int64_t clientBytes = numberLiveBytes.load() - start;
+    start = numberLiveBytes.load();
+    for (uint32_t idx = 0; idx < numberClients; ++idx) {
+        generators.push_back(LoadGenerator::build(clients[idx].get(), "hub", mix));
+    }
+    int64_t generatorBytes = numberLiveBytes.load() - start;
+
+    // The hub acks on its own thread, the generators step on this one
+    std::atomic<bool> isDone(false);
+    std::thread hub([&] {
+        while (!isDone.load()) {
+            bool isServed = false;
+            for (auto& client : clients) {
+                while (client->serve()) {
+                    isServed = true;
+                }
+            }
+            if (!isServed) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint64_t end = TIMESTAMP_MICRO_SECS() + duration;
+    while (TIMESTAMP_MICRO_SECS() < end) {
+        for (auto& generator : generators) {
+            generator->step();
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(STEP_INTERVAL));
+    }
+    // The messages in flight are acked before the totals are taken
+    uint64_t deadline = TIMESTAMP_MICRO_SECS() + 1000000ULL;
+    LoadStats total;
+    do {
+        std::this_thread::sleep_for(std::chrono::microseconds(STEP_INTERVAL));
+        total = LoadStats();
+        for (auto& generator : generators) {
+            total.merge(generator->getStats());
+        }
+    } while (total.numberInFlight > 0 && TIMESTAMP_MICRO_SECS() < deadline);
+    isDone.store(true);
+    hub.join();
+
+    CHECK(total.numberSent > 0);
+    CHECK(total.numberInFlight == 0);
+    CHECK(total.numberFailed == 0);
+    printf("%u clients for %.1f s\n", numberClients, total.elapsed / 1000000.0);
+    printf("sent %u (%u msg/s, %llu bytes), rejected %u, acked %u, hub received %llu bytes\n",
+        total.numberSent, total.getThroughput(), (unsigned long long)total.bytesSent,
+        total.numberRejected, total.numberAcked, (unsigned long long)numberBytes.load());
+    printf("ack latency p50 %llu us, p99 %llu us, max %llu us\n",
+        (unsigned long long)total.getPercentile(50), (unsigned long long)total.getPercentile(99),
+        (unsigned long long)total.maxLatency);
+    printf("memory per client: connector %lld bytes, generator %lld bytes\n",
+        (long long)(clientBytes / numberClients), (long long)(generatorBytes / numberClients));
+    return 0;
+}
@@ -0,0 +1,71 @@
+// Consumer throughput of "ConcurrencyQueue" when "listen" takes frames one by one ("pop")
+// or in batches ("popBatch"), the socket reader pushes them from another thread
+#include <atomic>
+#include "host_test.h"
+#include "synchronization/concurrency_queue.h"
+
+#define CAPACITY 256
+#define FRAME_SIZE 64
+
+// Owns its bytes like the "Array<uint8_t>" frames of "Connection"
+struct Frame {
+    std::unique_ptr<uint8_t[]> bytes;
+    size_t length;
+
+    Frame() noexcept : bytes(), length(0) {}
+    Frame(size_t length) : bytes(new uint8_t[length]()), length(length) {}
+};
+
+static void benchmark(uint32_t batchSize, uint32_t numberFrames) {
+    ConcurrencyQueue<Frame> queue(CAPACITY);
+    uint64_t numberBytes = 0;
+    uint64_t elapsed = runThreads(2, [&](uint32_t idx) {
+        if (idx == 0) {
+            for (uint32_t number = 0; number < numberFrames; ++number) {
+                Frame frame(FRAME_SIZE);
+                while (queue.push(std::move(frame)) != Error::Nil) {
+                    std::this_thread::yield();
+                }
+            }
+            return;
+        }
+
+        std::vector<Frame> frames(batchSize);
+        uint32_t numberPopped = 0;
+        while (numberPopped < numberFrames) {
+            uint32_t count = 0;
+            if (batchSize == 1) {
+                Result<Frame> result = queue.pop();
+                if (result.errorCode == Error::Nil) {
+                    frames[0] = std::move(result.data);
+                    count = 1;
+                }
+            } else {
+                count = queue.popBatch(frames.data(), batchSize);
+            }
+            if (count == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (uint32_t pos = 0; pos < count; ++pos) {
+                numberBytes += frames[pos].length;
+                frames[pos] = Frame();
+            }
+            numberPopped += count;
+        }
+    });
+    CHECK(numberBytes == (uint64_t)numberFrames * FRAME_SIZE);
+
+    char name[64];
+    snprintf(name, sizeof(name), batchSize == 1 ? "pop (one frame)" : "popBatch (%u frames)", batchSize);
+    reportThroughput(name, 2, numberFrames, elapsed);
+}
+
+int main(int argc, char** argv) {
+    uint32_t numberFrames = isQuick(argc, argv) ? 1000 : 2000000;
+    const uint32_t batchSizes[] = { 1, 4, 8, 32 };
+    for (uint32_t batchSize : batchSizes) {
+        benchmark(batchSize, numberFrames);
+    }
+    return 0;
+}
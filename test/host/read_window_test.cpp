@@ -0,0 +1,94 @@
+// "ReadWindow" against a model which keeps every read index in a set.
+// Random reads, duplicates, late and far ahead indexes slide the window in every way
+#include <set>
+#include <random>
+#include "host_test.h"
+#include "cso_counter/read_window.h"
+
+#define NUMBER_OPERATIONS 200000
+#define WINDOW_BITS 256
+
+class ReadModel {
+private:
+    uint64_t minReadIndex;
+    uint32_t windowBits;
+    std::set<uint64_t> readIndexes;
+
+public:
+    ReadModel(uint64_t minReadIndex, uint32_t maskReadBits, uint32_t windowBits)
+        : minReadIndex(minReadIndex),
+          windowBits(windowBits),
+          readIndexes() {
+        for (uint32_t bit = 0; bit < 32; ++bit) {
+            if ((maskReadBits & (0x01U << bit)) != 0) {
+                this->readIndexes.insert(minReadIndex + bit);
+            }
+        }
+    }
+
+    void markReadUnused(uint64_t index) {
+        if (index >= this->minReadIndex && index < this->minReadIndex + this->windowBits) {
+            this->readIndexes.erase(index);
+        }
+    }
+
+    bool markReadDone(uint64_t index) {
+        if (index < this->minReadIndex) {
+            return false;
+        }
+        if (index >= this->minReadIndex + this->windowBits) {
+            this->minReadIndex = index - this->windowBits + 1;
+            this->readIndexes.erase(this->readIndexes.begin(), this->readIndexes.lower_bound(this->minReadIndex));
+        }
+        return this->readIndexes.insert(index).second;
+    }
+};
+
+// Indexes are mostly around the newest one, some are late, some jump far ahead
+static uint64_t nextIndex(std::mt19937_64& random, uint64_t& newestIndex) {
+    uint32_t kind = random() % 100;
+    if (kind < 70) {
+        newestIndex += random() % 4;
+        return newestIndex - random() % 8;
+    }
+    if (kind < 95) {
+        return newestIndex - random() % (2 * WINDOW_BITS);
+    }
+    if (kind < 99) {
+        newestIndex += random() % (WINDOW_BITS + 64);
+        return newestIndex;
+    }
+    newestIndex += 3 * WINDOW_BITS + random() % 1000;
+    return newestIndex;
+}
+
+static void testAgainstModel(uint64_t minReadIndex, uint32_t maskReadBits, uint64_t seed) {
+    uint32_t readBits[WINDOW_BITS / 32];
+    ReadWindow window;
+    window.bind(readBits, WINDOW_BITS);
+    window.reset(minReadIndex, maskReadBits);
+    ReadModel model(minReadIndex, maskReadBits, WINDOW_BITS);
+    std::mt19937_64 random(seed);
+    uint64_t newestIndex = minReadIndex + 16;
+    for (uint32_t number = 0; number < NUMBER_OPERATIONS; ++number) {
+        uint64_t index = nextIndex(random, newestIndex);
+        if (index < minReadIndex) {
+            index = minReadIndex;
+        }
+        if (random() % 10 == 0) {
+            window.markReadUnused(index);
+            model.markReadUnused(index);
+            continue;
+        }
+        CHECK(window.markReadDone(index) == model.markReadDone(index));
+    }
+}
+
+int main() {
+    testAgainstModel(0, 0, 1);
+    testAgainstModel(0, 0xFFFFFFFFU, 2);
+    testAgainstModel(1000, 0x5A5A5A5AU, 3);
+    testAgainstModel(0x00000000FFFFFF00ULL, 0x0000FFFFU, 4);
+    testAgainstModel(0x7FFFFFFFFFFF0000ULL, 0x80000001U, 5);
+    return 0;
+}
@@ -0,0 +1,95 @@
+// "Reassembler" joins fragments in any order and counts retried or overlapping fragments once
+#include "host_test.h"
+#include "cso_connector/reassembler.h"
+
+#define LENGTH_MESSAGE 1000
+
+static uint8_t message[LENGTH_MESSAGE];
+
+// Builds the fragment of ["offset", "offset" + "lenPart") into "fragment", returns its length
+static uint16_t buildFragment(uint8_t* fragment, uint32_t transferID, uint32_t offset, uint32_t lenPart) {
+    uint32_t lenMessage = LENGTH_MESSAGE;
+    memcpy(fragment, &transferID, sizeof(uint32_t));
+    memcpy(fragment + 4, &lenMessage, sizeof(uint32_t));
+    memcpy(fragment + 8, &offset, sizeof(uint32_t));
+    memcpy(fragment + FRAGMENT_HEADER_SIZE, message + offset, lenPart);
+    return lenPart + FRAGMENT_HEADER_SIZE;
+}
+
+static uint8_t addPart(Reassembler* reassembler, uint32_t transferID, uint32_t offset, uint32_t lenPart) {
+    uint8_t fragment[FRAGMENT_HEADER_SIZE + LENGTH_MESSAGE];
+    uint16_t lenFragment = buildFragment(fragment, transferID, offset, lenPart);
+    uint8_t slot = 0xFF;
+    CHECK(reassembler->addFragment("sender", fragment, lenFragment, slot) == Error::Nil);
+    return slot;
+}
+
+static void checkContent(Reassembler* reassembler, uint8_t slot) {
+    CHECK(reassembler->isComplete(slot));
+    CHECK(reassembler->getLength(slot) == LENGTH_MESSAGE);
+    CHECK(memcmp(reassembler->getContent(slot), message, LENGTH_MESSAGE) == 0);
+}
+
+// Fragments come in reverse order
+static void testOrder() {
+    std::unique_ptr<Reassembler> reassembler = Reassembler::build();
+    uint8_t slot = 0;
+    for (int32_t offset = 900; offset >= 0; offset -= 100) {
+        CHECK(slot == 0 || !reassembler->isComplete(slot));
+        slot = addPart(reassembler.get(), 1, offset, 100);
+    }
+    checkContent(reassembler.get(), slot);
+}
+
+// A retried fragment does not complete a message which misses another one
+static void testRetry() {
+    std::unique_ptr<Reassembler> reassembler = Reassembler::build();
+    uint8_t slot = 0;
+    for (uint32_t offset = 0; offset < 900; offset += 100) {
+        slot = addPart(reassembler.get(), 2, offset, 100);
+        slot = addPart(reassembler.get(), 2, offset, 100);
+    }
+    CHECK(!reassembler->isComplete(slot));
+    slot = addPart(reassembler.get(), 2, 900, 100);
+    checkContent(reassembler.get(), slot);
+}
+
+// Fragments which overlap count their common bytes once
+static void testOverlap() {
+    std::unique_ptr<Reassembler> reassembler = Reassembler::build();
+    uint8_t slot = addPart(reassembler.get(), 3, 0, 600);
+    slot = addPart(reassembler.get(), 3, 300, 600);
+    CHECK(!reassembler->isComplete(slot));
+    slot = addPart(reassembler.get(), 3, 899, 101);
+    checkContent(reassembler.get(), slot);
+}
+
+// A reverted fragment is missing until it comes again
+static void testRevert() {
+    std::unique_ptr<Reassembler> reassembler = Reassembler::build();
+    uint8_t fragment[FRAGMENT_HEADER_SIZE + LENGTH_MESSAGE];
+    addPart(reassembler.get(), 4, 0, 500);
+    uint16_t lenFragment = buildFragment(fragment, 4, 500, 500);
+    uint8_t slot;
+    CHECK(reassembler->addFragment("sender", fragment, lenFragment, slot) == Error::Nil);
+    CHECK(reassembler->isComplete(slot));
+    reassembler->revertFragment(slot, fragment, lenFragment);
+    CHECK(!reassembler->isComplete(slot));
+    // Bytes of the first fragment are still received
+    addPart(reassembler.get(), 4, 0, 500);
+    CHECK(!reassembler->isComplete(slot));
+    CHECK(reassembler->addFragment("sender", fragment, lenFragment, slot) == Error::Nil);
+    checkContent(reassembler.get(), slot);
+    reassembler->release(slot);
+}
+
+int main() {
+    for (uint32_t idx = 0; idx < LENGTH_MESSAGE; ++idx) {
+        message[idx] = (uint8_t)(idx * 7 + 3);
+    }
+    testOrder();
+    testRetry();
+    testOverlap();
+    testRevert();
+    return 0;
+}
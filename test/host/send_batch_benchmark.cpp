@@ -0,0 +1,74 @@
+// Enqueue throughput of "sendMessagesAndRetry" (one "takeIndexes" for a batch) against
+// "sendMessageAndRetry" for every message (one "takeIndex" each), with senders on many threads
+// and one thread which sends and acknowledges like "listen"
+#include <atomic>
+#include "host_test.h"
+#include "cso_queue/queue.h"
+
+#define CAPACITY 256
+#define BATCH_SIZE 8
+#define LENGTH_CONTENT 32
+
+static void countAck(uint64_t, SendStatus::Code status, void* context) {
+    if (status == SendStatus::Acked) {
+        static_cast<std::atomic<uint64_t>*>(context)->fetch_add(1);
+    }
+}
+
+static void pushMessage(IQueue* queue, uint64_t msgID, uint8_t* content, std::atomic<uint64_t>* numberAcked) {
+    Error::Code error = queue->pushMessage(msgID, 0, "receiver", content, LENGTH_CONTENT,
+        false, false, true, true, true, false, Priority::Normal, 1, 0, countAck, numberAcked);
+    CHECK(error == Error::Nil);
+}
+
+static void benchmark(uint32_t numberSenders, uint32_t batchSize, uint32_t numberBatches) {
+    std::unique_ptr<IQueue> queue = Queue::build(CAPACITY);
+    std::atomic<uint64_t> nextMsgID(1);
+    std::atomic<uint64_t> numberAcked(0);
+    uint64_t total = (uint64_t)numberSenders * numberBatches * batchSize;
+    uint64_t elapsed = runThreads(numberSenders + 1, [&](uint32_t idx) {
+        uint8_t content[LENGTH_CONTENT] = { 0 };
+        if (idx < numberSenders) {
+            for (uint32_t number = 0; number < numberBatches; ++number) {
+                if (batchSize > 1) {
+                    while (!queue->takeIndexes(batchSize)) {
+                        std::this_thread::yield();
+                    }
+                    for (uint32_t pos = 0; pos < batchSize; ++pos) {
+                        pushMessage(queue.get(), nextMsgID.fetch_add(1), content, &numberAcked);
+                    }
+                    continue;
+                }
+                while (!queue->takeIndex()) {
+                    std::this_thread::yield();
+                }
+                pushMessage(queue.get(), nextMsgID.fetch_add(1), content, &numberAcked);
+            }
+            return;
+        }
+
+        while (numberAcked.load() < total) {
+            ItemQueueRef ref = queue->nextMessage();
+            if (ref.empty()) {
+                std::this_thread::yield();
+                continue;
+            }
+            queue->clearMessage(ref.get().msgID);
+        }
+    });
+    CHECK(numberAcked.load() == total);
+
+    char name[64];
+    snprintf(name, sizeof(name), batchSize > 1 ? "takeIndexes(%u) + push" : "takeIndex + push", batchSize);
+    reportThroughput(name, numberSenders + 1, total, elapsed);
+}
+
+int main(int argc, char** argv) {
+    uint32_t numberMessages = isQuick(argc, argv) ? 256 : 100000; // (per sender)
+    const uint32_t numberSenders[] = { 1, 4 };
+    for (uint32_t number : numberSenders) {
+        benchmark(number, 1, numberMessages);
+        benchmark(number, BATCH_SIZE, numberMessages / BATCH_SIZE);
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Inbound deduplication of "SenderCounter": a window per sender,
+// and a mark per evicted sender which outlives the eviction
+#include "host_test.h"
+#include "cso_counter/sender_counter.h"
+
+// Tags of senders do not mark each other as read
+static void testSenders() {
+    std::unique_ptr<SenderCounter> senderCounter = SenderCounter::build();
+    CHECK(senderCounter->markReadDone("alice", 10));
+    CHECK(senderCounter->markReadDone("bob", 10));
+    CHECK(!senderCounter->markReadDone("alice", 10));
+    CHECK(!senderCounter->markReadDone("bob", 10));
+    CHECK(senderCounter->markReadDone("alice", 11));
+    // A bit late, but not read yet
+    CHECK(senderCounter->markReadDone("bob", 5));
+}
+
+// A sender which was evicted from the table comes back with a retry
+static void testRedeliveryAfterEviction() {
+    std::unique_ptr<SenderCounter> senderCounter = SenderCounter::build(1, 256);
+    CHECK(senderCounter->markReadDone("alice", 200));
+    CHECK(senderCounter->markReadDone("alice", 190));
+    CHECK(senderCounter->markReadDone("bob", 3000));
+    CHECK(!senderCounter->markReadDone("alice", 200));
+    CHECK(!senderCounter->markReadDone("alice", 190));
+    CHECK(senderCounter->markReadDone("alice", 195));
+    CHECK(senderCounter->markReadDone("alice", 201));
+}
+
+// Retries far beyond the window of the sender which evicted it
+static void testFarRedeliveryAfterEviction() {
+    std::unique_ptr<SenderCounter> senderCounter = SenderCounter::build(1, 256);
+    CHECK(senderCounter->markReadDone("alice", 1000));
+    CHECK(senderCounter->markReadDone("bob", 3000));
+    CHECK(!senderCounter->markReadDone("alice", 1000));
+    CHECK(senderCounter->markReadDone("alice", 1001));
+    CHECK(!senderCounter->markReadDone("bob", 3000));
+    CHECK(senderCounter->markReadDone("bob", 2999));
+}
+
+// Tags which an evicted sender read are not read for another sender
+static void testNewSenderAfterEviction() {
+    std::unique_ptr<SenderCounter> senderCounter = SenderCounter::build(1, 256);
+    CHECK(senderCounter->markReadDone("alice", 100));
+    CHECK(senderCounter->markReadDone("bob", 5000));
+    CHECK(senderCounter->markReadDone("carol", 100));
+    CHECK(!senderCounter->markReadDone("alice", 100));
+    CHECK(!senderCounter->markReadDone("carol", 100));
+}
+
+// More senders than the table holds take turns, each one far from the tags of the others
+static void testSendersInTurn() {
+    const char* senders[] = { "alice", "bob", "carol", "dave", "erin", "frank" };
+    std::unique_ptr<SenderCounter> senderCounter = SenderCounter::build(2, 256);
+    for (uint64_t round = 0; round < 20; ++round) {
+        for (uint64_t idx = 0; idx < 6; ++idx) {
+            uint64_t tag = idx * 100000 + round * 1000;
+            CHECK(senderCounter->markReadDone(senders[idx], tag));
+            CHECK(!senderCounter->markReadDone(senders[idx], tag));
+        }
+        // Retries of every sender after it was evicted
+        for (uint64_t idx = 0; idx < 6; ++idx) {
+            CHECK(!senderCounter->markReadDone(senders[idx], idx * 100000 + round * 1000));
+        }
+    }
+}
+
+// A message which was not delivered is marked unused, its retry is delivered
+static void testUnused() {
+    std::unique_ptr<SenderCounter> senderCounter = SenderCounter::build();
+    CHECK(senderCounter->markReadDone("alice", 7));
+    senderCounter->markReadUnused("alice", 7);
+    CHECK(senderCounter->markReadDone("alice", 7));
+}
+
+int main() {
+    testSenders();
+    testRedeliveryAfterEviction();
+    testFarRedeliveryAfterEviction();
+    testNewSenderAfterEviction();
+    testSendersInTurn();
+    testUnused();
+    return 0;
+}
@@ -0,0 +1,115 @@
+#ifndef _TEST_HOST_SHIM_WIFI_H_
+#define _TEST_HOST_SHIM_WIFI_H_
+
+// The part of "WiFiClient" of the esp32 Arduino core which "Connection" uses, over a POSIX socket.
+// The station is always connected on the host
+#include <cerrno>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#define ESP_OK 0
+#define WL_CONNECTED 3
+// "SO_KEEPALIVE" of lwip
+#define LWIP_SO_KEEPALIVE 0x0008
+
+// "vTaskDelay" of FreeRTOS, a tick is a milli second
+inline void vTaskDelay(uint32_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+class WiFiClass {
+public:
+    int status() { return WL_CONNECTED; }
+};
+
+static WiFiClass WiFi __attribute__((unused));
+
+class WiFiClient {
+private:
+    int socket;
+
+public:
+    WiFiClient() : socket(-1) {}
+    ~WiFiClient() { stop(); }
+
+    int connect(const char* host, uint16_t port) {
+        stop();
+        struct addrinfo hints = {};
+        struct addrinfo* addr = nullptr;
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        if (getaddrinfo(host, std::to_string(port).c_str(), &hints, &addr) != 0) {
+            return 0;
+        }
+        this->socket = ::socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (this->socket >= 0 && ::connect(this->socket, addr->ai_addr, addr->ai_addrlen) != 0) {
+            stop();
+        }
+        freeaddrinfo(addr);
+        return this->socket >= 0 ? 1 : 0;
+    }
+
+    void stop() {
+        if (this->socket >= 0) {
+            close(this->socket);
+            this->socket = -1;
+        }
+    }
+
+    int available() {
+        int available = 0;
+        if (this->socket < 0 || ioctl(this->socket, FIONREAD, &available) != 0) {
+            return 0;
+        }
+        return available;
+    }
+
+    int read(uint8_t* buffer, size_t size) {
+        return (int)recv(this->socket, buffer, size, 0);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) {
+        ssize_t sent = send(this->socket, buffer, size, MSG_NOSIGNAL);
+        return sent > 0 ? (size_t)sent : 0;
+    }
+
+    // "seconds" for reads and writes
+    int setTimeout(uint32_t seconds) {
+        struct timeval interval = {};
+        interval.tv_sec = seconds;
+        if (setsockopt(this->socket, SOL_SOCKET, SO_RCVTIMEO, &interval, sizeof(interval)) != 0 ||
+            setsockopt(this->socket, SOL_SOCKET, SO_SNDTIMEO, &interval, sizeof(interval)) != 0) {
+            return -1;
+        }
+        return ESP_OK;
+    }
+
+    int setSocketOption(int option, char* value, size_t size) {
+        if (option == LWIP_SO_KEEPALIVE) {
+            option = SO_KEEPALIVE;
+        }
+        return setsockopt(this->socket, SOL_SOCKET, option, value, size);
+    }
+
+    int fd() const {
+        return this->socket;
+    }
+
+    // The peer closed the socket if it is readable without data
+    bool connected() {
+        if (this->socket < 0) {
+            return false;
+        }
+        uint8_t byte;
+        ssize_t peeked = recv(this->socket, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+        return peeked > 0 || (peeked < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+    }
+};
+
+#endif //_TEST_HOST_SHIM_WIFI_H_
@@ -0,0 +1,9 @@
+#ifndef _TEST_HOST_SHIM_ESP_LOG_H_
+#define _TEST_HOST_SHIM_ESP_LOG_H_
+
+#include <cstdio>
+
+// "log_e" of the esp32 Arduino core, errors are printed to "stderr"
+#define log_e(format, ...) fprintf(stderr, "[E] " format "\n", ##__VA_ARGS__)
+
+#endif //_TEST_HOST_SHIM_ESP_LOG_H_
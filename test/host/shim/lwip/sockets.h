@@ -0,0 +1,13 @@
+#ifndef _TEST_HOST_SHIM_LWIP_SOCKETS_H_
+#define _TEST_HOST_SHIM_LWIP_SOCKETS_H_
+
+// The BSD socket API of lwip is the POSIX one, except "closesocket"
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+#define closesocket(socket) close(socket)
+
+#endif //_TEST_HOST_SHIM_LWIP_SOCKETS_H_
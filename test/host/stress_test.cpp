@@ -0,0 +1,177 @@
+// Hammers the shared structures from many threads and prints their throughput under contention.
+// Configure with "-DCSO_SANITIZER=thread" to run it under ThreadSanitizer.
+#include <atomic>
+#include <algorithm>
+#include "host_test.h"
+#include "cso_queue/queue.h"
+#include "cso_counter/counter.h"
+#include "synchronization/event.h"
+#include "synchronization/spin_lock.h"
+#include "synchronization/concurrency_queue.h"
+
+#define NUMBER_THREADS 4
+#define NUMBER_OPERATIONS 50000 // (per thread)
+#define NUMBER_ROUNDS 2000
+#define WAIT_TIME 5000 // (milli seconds)
+
+static void stressSpinLock(uint32_t numberThreads) {
+    SpinLock spin;
+    uint64_t total = 0;
+    uint64_t elapsed = runThreads(numberThreads, [&](uint32_t) {
+        for (uint32_t idx = 0; idx < NUMBER_OPERATIONS; ++idx) {
+            spin.lock();
+            total++;
+            spin.unlock();
+        }
+    });
+    CHECK(total == (uint64_t)numberThreads * NUMBER_OPERATIONS);
+    reportThroughput("SpinLock lock/unlock", numberThreads, total, elapsed);
+}
+
+// Two threads wake up each other, a lost "notify" would stall a round until "WAIT_TIME"
+static void stressEvent() {
+    Event ping;
+    Event pong;
+    std::atomic<uint32_t> numberTimeouts(0);
+    uint64_t elapsed = runThreads(2, [&](uint32_t idx) {
+        for (uint32_t round = 0; round < NUMBER_ROUNDS; ++round) {
+            if (idx == 0) {
+                ping.notify();
+                if (!pong.wait(WAIT_TIME)) {
+                    numberTimeouts++;
+                }
+            } else {
+                if (!ping.wait(WAIT_TIME)) {
+                    numberTimeouts++;
+                }
+                pong.notify();
+            }
+        }
+    });
+    CHECK(numberTimeouts.load() == 0);
+    reportThroughput("Event notify/wait round trips", 2, NUMBER_ROUNDS, elapsed);
+}
+
+// Every index is taken once and the indexes have no gaps
+static void stressCounter(uint32_t numberThreads) {
+    std::unique_ptr<ICounter> counter = Counter::build(1000);
+    std::vector<std::vector<uint64_t>> indexes(numberThreads);
+    uint64_t elapsed = runThreads(numberThreads, [&](uint32_t idx) {
+        indexes[idx].reserve(NUMBER_OPERATIONS);
+        for (uint32_t number = 0; number < NUMBER_OPERATIONS; ++number) {
+            indexes[idx].push_back(counter->nextWriteIndex());
+        }
+    });
+
+    std::vector<uint64_t> all;
+    for (auto& part : indexes) {
+        all.insert(all.end(), part.begin(), part.end());
+    }
+    std::sort(all.begin(), all.end());
+    for (size_t idx = 1; idx < all.size(); ++idx) {
+        CHECK(all[idx] == all[idx - 1] + 1);
+    }
+    reportThroughput("Counter::nextWriteIndex", numberThreads, all.size(), elapsed);
+}
+
+// Producers and consumers share the ring, every consumer sees the values of a producer in order
+static void stressConcurrencyQueue(uint32_t numberProducers, uint32_t numberConsumers) {
+    ConcurrencyQueue<uint32_t> queue(256);
+    std::atomic<uint64_t> sum(0);
+    std::atomic<uint64_t> numberPopped(0);
+    uint64_t total = (uint64_t)numberProducers * NUMBER_OPERATIONS;
+    uint64_t elapsed = runThreads(numberProducers + numberConsumers, [&](uint32_t idx) {
+        if (idx < numberProducers) {
+            for (uint32_t seq = 0; seq < NUMBER_OPERATIONS; ++seq) {
+                uint32_t value = (idx << 24) | seq;
+                while (queue.push(value) != Error::Nil) {
+                    std::this_thread::yield();
+                }
+            }
+            return;
+        }
+
+        std::vector<int64_t> lastSeqs(numberProducers, -1);
+        uint32_t batch[8];
+        while (numberPopped.load() < total) {
+            uint32_t count = queue.popBatch(batch, 8);
+            if (count == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (uint32_t pos = 0; pos < count; ++pos) {
+                uint32_t producer = batch[pos] >> 24;
+                int64_t seq = batch[pos] & 0x00FFFFFFU;
+                CHECK(producer < numberProducers);
+                CHECK(seq > lastSeqs[producer]);
+                lastSeqs[producer] = seq;
+                sum += seq;
+            }
+            numberPopped += count;
+        }
+    });
+
+    uint64_t expected = (uint64_t)numberProducers * ((uint64_t)NUMBER_OPERATIONS * (NUMBER_OPERATIONS - 1) / 2);
+    CHECK(numberPopped.load() == total);
+    CHECK(sum.load() == expected);
+    CHECK(queue.empty());
+    char name[64];
+    snprintf(name, sizeof(name), "ConcurrencyQueue push/popBatch (%u+%u)", numberProducers, numberConsumers);
+    reportThroughput(name, numberProducers + numberConsumers, total, elapsed);
+}
+
+static void countAck(uint64_t, SendStatus::Code status, void* context) {
+    if (status == SendStatus::Acked) {
+        static_cast<std::atomic<uint64_t>*>(context)->fetch_add(1);
+    }
+}
+
+// Senders push reliable messages, one thread sends and acknowledges them like "listen"
+static void stressQueue(uint32_t numberSenders) {
+    std::unique_ptr<IQueue> queue = Queue::build(64);
+    std::atomic<uint64_t> nextMsgID(1);
+    std::atomic<uint64_t> numberAcked(0);
+    uint64_t total = (uint64_t)numberSenders * NUMBER_OPERATIONS / 10;
+    uint8_t content[32] = { 0 };
+    uint64_t elapsed = runThreads(numberSenders + 1, [&](uint32_t idx) {
+        if (idx < numberSenders) {
+            for (uint32_t number = 0; number < NUMBER_OPERATIONS / 10; ++number) {
+                while (!queue->takeIndex()) {
+                    std::this_thread::yield();
+                }
+                Error::Code error = queue->pushMessage(nextMsgID.fetch_add(1), 0, "receiver", content, sizeof(content),
+                    false, false, true, true, true, false, Priority::Normal, 1, 0, countAck, &numberAcked);
+                CHECK(error == Error::Nil);
+            }
+            return;
+        }
+
+        while (numberAcked.load() < total) {
+            ItemQueueRef ref = queue->nextMessage();
+            if (ref.empty()) {
+                std::this_thread::yield();
+                continue;
+            }
+            queue->clearMessage(ref.get().msgID);
+        }
+    });
+
+    CHECK(numberAcked.load() == total);
+    LaneStats stats = queue->getLaneStats(Priority::Normal);
+    CHECK(stats.numberSent == total);
+    CHECK(stats.depth == 0);
+    reportThroughput("Queue push/nextMessage/clearMessage", numberSenders + 1, total, elapsed);
+}
+
+int main() {
+    stressSpinLock(1);
+    stressSpinLock(NUMBER_THREADS);
+    stressEvent();
+    stressCounter(1);
+    stressCounter(NUMBER_THREADS);
+    stressConcurrencyQueue(1, 1);
+    stressConcurrencyQueue(NUMBER_THREADS / 2, NUMBER_THREADS / 2);
+    stressQueue(1);
+    stressQueue(NUMBER_THREADS);
+    return 0;
+}